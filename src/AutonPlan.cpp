@@ -0,0 +1,269 @@
+/**
+ * Implementation of the AutonPlan structure.
+ */
+
+#include "AutonPlan.h"
+
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+
+using namespace avc;
+using namespace std;
+
+namespace {
+  // Text name, number of values and legal range of each value of an op
+  struct OpInfo {
+    uint8_t op;
+    const char* name;
+    int argCount;
+    const char* argNames[3];
+    float minArg[3];
+    float maxArg[3];
+  };
+
+  const OpInfo opInfos[] = {
+    { PlanStep::DRIVE_POWER_TIME, "drive-power-time", 3,
+      { "left power", "right power", "seconds" }, { -1, -1, 0 }, { 1, 1, 60 } },
+    { PlanStep::DRIVE_STRAIGHT, "drive-straight", 2,
+      { "heading", "minimum seconds", 0 }, { -360, 0, 0 }, { 360, 60, 0 } },
+    { PlanStep::BRAKE, "brake", 1,
+      { "seconds", 0, 0 }, { 0, 0, 0 }, { 60, 0, 0 } },
+    // MakeTurn blows up on turns much past 150 degrees
+    { PlanStep::MAKE_TURN, "make-turn", 1,
+      { "degrees", 0, 0 }, { -150, 0, 0 }, { 150, 0, 0 } },
+    { PlanStep::MAKE_SMOOTH_TURN, "make-smooth-turn", 1,
+      { "degrees", 0, 0 }, { -150, 0, 0 }, { 150, 0, 0 } },
+    { PlanStep::DRIVE_TO_TURN, "drive-to-turn", 2,
+      { "power", "timeout seconds", 0 }, { -1, 0, 0 }, { 1, 60, 0 } }
+  };
+
+  const int opInfoCount = sizeof(opInfos) / sizeof(opInfos[0]);
+
+  // Word after the values of drive-straight to set the RELATIVE flag
+  const char* RELATIVE_WORD = "relative";
+
+  const OpInfo* findOp(uint8_t op) {
+    for (int i = 0; i < opInfoCount; i++) {
+      if (opInfos[i].op == op) {
+        return &opInfos[i];
+      }
+    }
+    return 0;
+  }
+
+  const OpInfo* findOp(const string& name) {
+    for (int i = 0; i < opInfoCount; i++) {
+      if (name == opInfos[i].name) {
+        return &opInfos[i];
+      }
+    }
+    return 0;
+  }
+
+  // Size of everything in front of the steps
+  const size_t headerSize = offsetof(AutonPlan, steps);
+}
+
+AutonPlan::AutonPlan() {
+  clear();
+}
+
+void AutonPlan::clear() {
+  memset(this, 0, sizeof(*this));
+  magic = MAGIC;
+  version = VERSION;
+  stepSize = sizeof(PlanStep);
+}
+
+bool AutonPlan::add(PlanStep::Op op, float a0, float a1, float a2, uint8_t flags) {
+  if (count >= (uint32_t) MAX_STEPS) {
+    return false;
+  }
+  PlanStep& step = steps[count++];
+  memset(&step, 0, sizeof(step));
+  step.op = op;
+  step.flags = flags;
+  step.args[0] = a0;
+  step.args[1] = a1;
+  step.args[2] = a2;
+  return true;
+}
+
+bool AutonPlan::parse(istream& in, const string& name) {
+  clear();
+
+  bool ok = true;
+  string line;
+  for (int lineNum = 1; getline(in, line); lineNum++) {
+    size_t comment = line.find('#');
+    if (comment != string::npos) {
+      line.erase(comment);
+    }
+
+    istringstream words(line);
+    string opWord;
+    if (!(words >> opWord)) {
+      continue;
+    }
+
+    const OpInfo* info = findOp(opWord);
+    if (info == 0) {
+      cerr << "***ERROR*** " << name << ":" << lineNum << ": Unknown step \"" << opWord << "\"\n";
+      ok = false;
+      continue;
+    }
+
+    float args[3] = { 0, 0, 0 };
+    int n = 0;
+    while ((n < info->argCount) && (words >> args[n])) {
+      n++;
+    }
+
+    uint8_t flags = 0;
+    string extra;
+    words.clear();
+    if (words >> extra) {
+      if ((info->op == PlanStep::DRIVE_STRAIGHT) && (extra == RELATIVE_WORD)) {
+        flags |= PlanStep::RELATIVE;
+        extra.clear();
+        words >> extra;
+      }
+    }
+
+    if ((n != info->argCount) || !extra.empty()) {
+      cerr << "***ERROR*** " << name << ":" << lineNum << ": Expected " << info->name;
+      for (int i = 0; i < info->argCount; i++) {
+        cerr << " <" << info->argNames[i] << ">";
+      }
+      cerr << ((info->op == PlanStep::DRIVE_STRAIGHT) ? " [relative]" : "") << "\n";
+      ok = false;
+      continue;
+    }
+
+    if (!add((PlanStep::Op) info->op, args[0], args[1], args[2], flags)) {
+      cerr << "***ERROR*** " << name << ":" << lineNum << ": More than "
+           << MAX_STEPS << " steps\n";
+      return false;
+    }
+  }
+
+  // Also reports values out of range on lines that did parse
+  bool valid = validate();
+  return ok && valid;
+}
+
+bool AutonPlan::validate() const {
+  if ((magic != MAGIC) || (version != VERSION) || (stepSize != sizeof(PlanStep))) {
+    cerr << "***ERROR*** Plan is version " << version << " with " << stepSize
+         << " byte steps (expected version " << VERSION << " with "
+         << sizeof(PlanStep) << " byte steps)\n";
+    return false;
+  }
+  if ((count == 0) || (count > (uint32_t) MAX_STEPS)) {
+    cerr << "***ERROR*** Plan has " << count << " steps (must be 1 to " << MAX_STEPS << ")\n";
+    return false;
+  }
+
+  bool ok = true;
+  for (uint32_t i = 0; i < count; i++) {
+    const PlanStep& step = steps[i];
+    const OpInfo* info = findOp(step.op);
+    if (info == 0) {
+      cerr << "***ERROR*** Plan step " << (i + 1) << " has unknown op " << (int) step.op << "\n";
+      ok = false;
+      continue;
+    }
+
+    uint8_t legalFlags = (step.op == PlanStep::DRIVE_STRAIGHT) ? PlanStep::RELATIVE : 0;
+    if ((step.flags & ~legalFlags) != 0) {
+      cerr << "***ERROR*** Plan step " << (i + 1) << " (" << info->name
+           << ") has unknown flags " << (int) step.flags << "\n";
+      ok = false;
+    }
+
+    for (int a = 0; a < info->argCount; a++) {
+      float val = step.args[a];
+      // Written so NaN fails as well
+      if (!((val >= info->minArg[a]) && (val <= info->maxArg[a]))) {
+        cerr << "***ERROR*** Plan step " << (i + 1) << " (" << info->name << ") "
+             << info->argNames[a] << " of " << val << " is not in range of ["
+             << info->minArg[a] << ", " << info->maxArg[a] << "]\n";
+        ok = false;
+      }
+    }
+  }
+  return ok;
+}
+
+bool AutonPlan::load(const string& path) {
+  FILE* in = fopen(path.c_str(), "rb");
+  if (in == 0) {
+    cerr << "***ERROR*** Unable to open plan: " << path << "\n";
+    return false;
+  }
+
+  clear();
+  bool ok = (fread(this, headerSize, 1, in) == 1) && (magic == MAGIC);
+  if (!ok) {
+    cerr << "***ERROR*** Not a compiled plan file: " << path << "\n";
+  } else if ((version == VERSION) && (stepSize == sizeof(PlanStep)) &&
+             (count <= (uint32_t) MAX_STEPS)) {
+    ok = (fread(steps, sizeof(PlanStep), count, in) == count);
+    if (!ok) {
+      cerr << "***ERROR*** Compiled plan is truncated: " << path << "\n";
+    }
+  }
+  fclose(in);
+
+  if (ok && !validate()) {
+    cerr << "***ERROR*** Invalid plan: " << path << "\n";
+    ok = false;
+  }
+  if (!ok) {
+    clear();
+  }
+  return ok;
+}
+
+bool AutonPlan::save(const string& path) const {
+  FILE* out = fopen(path.c_str(), "wb");
+  if (out == 0) {
+    cerr << "***ERROR*** Unable to create plan: " << path << "\n";
+    return false;
+  }
+
+  bool ok = (fwrite(this, headerSize, 1, out) == 1) &&
+    (fwrite(steps, sizeof(PlanStep), count, out) == count);
+  ok = (fclose(out) == 0) && ok;
+  if (!ok) {
+    cerr << "***ERROR*** Unable to write plan: " << path << "\n";
+  }
+  return ok;
+}
+
+ostream& AutonPlan::print(ostream& out) const {
+  for (uint32_t i = 0; i < count; i++) {
+    const PlanStep& step = steps[i];
+    const OpInfo* info = findOp(step.op);
+    if (info == 0) {
+      out << "# unknown op " << (int) step.op << "\n";
+      continue;
+    }
+    out << info->name;
+    for (int a = 0; a < info->argCount; a++) {
+      out << " " << step.args[a];
+    }
+    if ((step.flags & PlanStep::RELATIVE) != 0) {
+      out << " " << RELATIVE_WORD;
+    }
+    out << "\n";
+  }
+  return out;
+}
+
+const char* AutonPlan::opName(uint8_t op) {
+  const OpInfo* info = findOp(op);
+  return (info != 0) ? info->name : "unknown";
+}
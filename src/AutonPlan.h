@@ -0,0 +1,148 @@
+/**
+ * Definition of the AutonPlan structure (a course plan compiled to a
+ * flat table of steps which can be loaded from a file).
+ */
+#ifndef __avc_AutonPlan_h
+#define __avc_AutonPlan_h
+
+#include <iostream>
+#include <string>
+
+#include <stdint.h>
+
+namespace avc {
+
+  /**
+   * One step of an auton plan (describes one of Timon's commands and
+   * the values to construct it with).
+   */
+  struct PlanStep {
+    /** Which command the step runs. */
+    enum Op {
+      /** DrivePowerTime: args = left power, right power, seconds. */
+      DRIVE_POWER_TIME = 1,
+      /** DriveStraight: args = heading, minimum seconds (flags: RELATIVE). */
+      DRIVE_STRAIGHT = 2,
+      /** Brake: args = seconds. */
+      BRAKE = 3,
+      /** MakeTurn: args = degrees (signed). */
+      MAKE_TURN = 4,
+      /** MakeSmoothTurn: args = degrees (signed). */
+      MAKE_SMOOTH_TURN = 5,
+      /** DriveToTurn: args = power, timeout seconds. */
+      DRIVE_TO_TURN = 6
+    };
+
+    /** DriveStraight heading is relative to the heading when the step starts. */
+    static const uint8_t RELATIVE = 0x01;
+
+    // One of the Op values
+    uint8_t op;
+    // Op specific flags (like RELATIVE)
+    uint8_t flags;
+    uint8_t reserved[2];
+    // Op specific values (unused values are 0)
+    float args[3];
+  };
+
+  /**
+   * Course plan for Timon as a fixed size table of steps (no pointers
+   * so the binary file is just the header followed by the steps and
+   * loading one is a couple of reads).
+   *
+   * <p>Plans are written as text (one step per line, '#' starts a
+   * comment) and compiled to the binary form with the avc-plan tool:</p>
+   *
+   * <pre>
+   * # Pause, then drive the first side of the course
+   * drive-power-time 0 0 0.25
+   * drive-straight 0 2.0
+   * brake 1.0
+   * drive-power-time -0.15 -0.15 0.6
+   * brake 0.5
+   * make-turn 90
+   * </pre>
+   *
+   * <p>The steps are validated when parsed and again when loaded, so a
+   * plan that loads is safe to hand to Timon::setAuton.</p>
+   */
+  struct AutonPlan {
+    // Identifies a compiled plan file
+    static const uint32_t MAGIC = 0x4e4c5041;
+
+    // Bumped when the layout of the steps changes
+    static const uint16_t VERSION = 1;
+
+    // Most steps a plan can have
+    static const int MAX_STEPS = 64;
+
+    uint32_t magic;
+    uint16_t version;
+    uint16_t stepSize;
+    uint32_t count;
+    uint32_t reserved;
+    PlanStep steps[MAX_STEPS];
+
+    /** Constructs an empty plan. */
+    AutonPlan();
+
+    /** Removes all of the steps. */
+    void clear();
+
+    /**
+     * Appends a step.
+     *
+     * @return false if the plan is full.
+     */
+    bool add(PlanStep::Op op, float a0 = 0, float a1 = 0, float a2 = 0, uint8_t flags = 0);
+
+    /**
+     * Replaces the plan with the steps of a text plan (see above).
+     *
+     * @param in Where to read the text from.
+     * @param name Name of the text (used in error messages).
+     *
+     * @return true if every line was understood and the plan is valid
+     * (problems are written to cerr).
+     */
+    bool parse(std::istream& in, const std::string& name);
+
+    /**
+     * Checks that every step has a known op and values in range.
+     *
+     * @return true if the plan is safe to run (problems are written to
+     * cerr).
+     */
+    bool validate() const;
+
+    /**
+     * Replaces the plan with a compiled plan file (and validates it).
+     *
+     * @return true if the file was read and is valid.
+     */
+    bool load(const std::string& path);
+
+    /**
+     * Writes the compiled form of the plan.
+     *
+     * @return true if the file was written.
+     */
+    bool save(const std::string& path) const;
+
+    /**
+     * Writes the text form of the plan (can be parsed back).
+     */
+    std::ostream& print(std::ostream& out) const;
+
+    /**
+     * Name of an op in the text form (like "make-turn").
+     */
+    static const char* opName(uint8_t op);
+  };
+
+  inline std::ostream& operator<<(std::ostream& out, const AutonPlan& plan) {
+    return plan.print(out);
+  }
+}
+
+#endif
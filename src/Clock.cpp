@@ -0,0 +1,26 @@
+/**
+ * Implementation of the Clock and RealClock classes.
+ */
+
+#include "Clock.h"
+
+#include <errno.h>
+
+using namespace avc;
+
+RealClock Clock::_realClock;
+__thread ClockSource* Clock::_source = 0;
+__thread int64_t Clock::_tickNanos = 0;
+__thread bool Clock::_inTick = false;
+
+int64_t RealClock::sleepUntil(int64_t deadlineNanos) {
+  timespec wakeAt;
+  wakeAt.tv_sec = (time_t) (deadlineNanos / 1000000000LL);
+  wakeAt.tv_nsec = (long) (deadlineNanos % 1000000000LL);
+
+  if (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wakeAt, 0) == 0) {
+    return 0;
+  }
+  int64_t left = deadlineNanos - nowNanos();
+  return (left > 0) ? left : 0;
+}
@@ -0,0 +1,263 @@
+/**
+ * Definition of the Clock used for all control loop time stamps and
+ * delays (and the real and virtual sources of time behind it).
+ */
+#ifndef __avc_Clock_h
+#define __avc_Clock_h
+
+#include <chrono>
+#include <ratio>
+
+#include <stdint.h>
+#include <time.h>
+
+namespace avc {
+
+  /**
+   * Source of time stamps and delays.
+   *
+   * <p>All times are nanoseconds on a monotonic time line (the epoch
+   * does not matter, only differences do).</p>
+   */
+  class ClockSource {
+
+  public:
+    virtual ~ClockSource() { }
+
+    /** Returns the current time in nanoseconds. */
+    virtual int64_t nowNanos() const = 0;
+
+    /**
+     * Waits until a point in time.
+     *
+     * @param deadlineNanos When to wake up (returns immediately if
+     * this time has already passed).
+     *
+     * @return 0 if the deadline was reached, otherwise the number of
+     * nanoseconds still left to wait (interrupted by a signal).
+     */
+    virtual int64_t sleepUntil(int64_t deadlineNanos) = 0;
+
+    /**
+     * Returns true if time only moves when the program moves it (no
+     * point in waiting on file descriptors for time to pass).
+     */
+    virtual bool isVirtual() const = 0;
+  };
+
+  /**
+   * The CLOCK_MONOTONIC time (the same clock clock_nanosleep,
+   * timerfd and avc-vision frame time stamps use).
+   */
+  class RealClock : public ClockSource {
+
+  public:
+    int64_t nowNanos() const {
+      timespec now;
+      clock_gettime(CLOCK_MONOTONIC, &now);
+      return now.tv_sec * 1000000000LL + now.tv_nsec;
+    }
+
+    int64_t sleepUntil(int64_t deadlineNanos);
+
+    bool isVirtual() const { return false; }
+  };
+
+  /**
+   * Time which only moves when it is advanced.
+   *
+   * <p>Sleeping simply moves the time forward to when the sleep would
+   * have ended, so commands (timeouts, brake durations, periodic
+   * timers) run deterministically and as fast as the CPU allows.</p>
+   *
+   * <pre>
+   * VirtualClock clock;
+   * ClockSource* prior = Clock::setSource(&clock);
+   * Timer timer;
+   * clock.advance(250000000);
+   * // timer.secsElapsed() is now 0.25
+   * Clock::setSource(prior);
+   * </pre>
+   */
+  class VirtualClock : public ClockSource {
+
+  public:
+    /**
+     * @param startNanos Time the clock starts at.
+     */
+    VirtualClock(int64_t startNanos = 0) : _nanos(startNanos) { }
+
+    int64_t nowNanos() const { return _nanos; }
+
+    int64_t sleepUntil(int64_t deadlineNanos) {
+      advanceTo(deadlineNanos);
+      return 0;
+    }
+
+    bool isVirtual() const { return true; }
+
+    /** Moves time forward (negative values are ignored). */
+    void advance(int64_t nanos) {
+      if (nanos > 0) {
+        _nanos += nanos;
+      }
+    }
+
+    /** Moves time forward to a point in time (never backwards). */
+    void advanceTo(int64_t timeNanos) {
+      advance(timeNanos - _nanos);
+    }
+
+  private:
+    int64_t _nanos;
+  };
+
+  /**
+   * Time stamps and delays used by Timer, PeriodicTimer and the
+   * telemetry records.
+   *
+   * <p>Each thread has its own clock source (RealClock unless the
+   * thread installs something else), so several simulations can run
+   * side by side on their own virtual clocks.</p>
+   *
+   * <p>While a tick of the control loop is running (see Tick), the
+   * clock is only read once: Timer and the timeouts of the commands
+   * use the time stamp taken at the start of the tick (tickNanos)
+   * instead of reading the clock again.</p>
+   */
+  class Clock {
+
+  public:
+    /** Returns the clock source of the current thread. */
+    static ClockSource& getSource() {
+      return (_source != 0) ? *_source : _realClock;
+    }
+
+    /**
+     * Changes the clock source of the current thread.
+     *
+     * @param source The new source of time (0 to go back to the real
+     * clock). The caller retains ownership and must keep it around
+     * until it is replaced.
+     *
+     * @return The prior clock source (0 if it was the real clock).
+     */
+    static ClockSource* setSource(ClockSource* source) {
+      ClockSource* prior = _source;
+      _source = source;
+      return prior;
+    }
+
+    /** Returns the current time in nanoseconds. */
+    static int64_t nowNanos() { return getSource().nowNanos(); }
+
+    /**
+     * Returns the time stamp of the tick the current thread is running
+     * (or the current time if it isn't running one).
+     */
+    static int64_t tickNanos() { return _inTick ? _tickNanos : nowNanos(); }
+
+    /** Returns true if the current thread is running a tick. */
+    static bool inTick() { return _inTick; }
+
+    /**
+     * Marks one tick of the control loop (the clock is sampled when
+     * constructed and that time stamp is used by everything run until
+     * it is destroyed).
+     *
+     * <pre>
+     * {
+     *   Clock::Tick tick;
+     *   state = command.execute();
+     * }
+     * </pre>
+     *
+     * <p>Ticks may nest, the inner one keeps the time stamp of the
+     * outer one.</p>
+     */
+    class Tick {
+
+    public:
+      Tick() : _outer(_inTick) {
+        if (!_outer) {
+          _tickNanos = nowNanos();
+          _inTick = true;
+        }
+      }
+
+      ~Tick() {
+        _inTick = _outer;
+      }
+
+      /** Time stamp of the tick. */
+      int64_t getNanos() const { return _tickNanos; }
+
+    private:
+      Tick(const Tick&);
+      Tick& operator=(const Tick&);
+
+      // Set if this tick is inside of another one
+      bool _outer;
+    };
+
+    /** Returns true if the current thread is running on virtual time. */
+    static bool isVirtual() { return getSource().isVirtual(); }
+
+    /**
+     * Waits until a point in time (see ClockSource::sleepUntil).
+     */
+    static int64_t sleepUntil(int64_t deadlineNanos) {
+      return getSource().sleepUntil(deadlineNanos);
+    }
+
+    /**
+     * Waits for a period of time.
+     *
+     * @return 0 if the full time passed, otherwise the number of
+     * nanoseconds still left to wait (interrupted by a signal).
+     */
+    static int64_t sleepNanos(int64_t nanos) {
+      ClockSource& source = getSource();
+      return source.sleepUntil(source.nowNanos() + nanos);
+    }
+
+  private:
+    static RealClock _realClock;
+    static __thread ClockSource* _source;
+    static __thread int64_t _tickNanos;
+    static __thread bool _inTick;
+  };
+
+  /**
+   * std::chrono view of the Clock of the current thread (so time
+   * stamps can be handed to code written against std::chrono, the
+   * same as a std::chrono::steady_clock, but follows virtual time and
+   * ticks - see Clock::tickNanos).
+   *
+   * <pre>
+   * ChronoClock::time_point start = ChronoClock::now();
+   * ...
+   * std::chrono::milliseconds took =
+   *   std::chrono::duration_cast<std::chrono::milliseconds>(ChronoClock::now() - start);
+   * </pre>
+   */
+  struct ChronoClock {
+    typedef int64_t rep;
+    typedef std::nano period;
+    typedef std::chrono::duration<rep, period> duration;
+    typedef std::chrono::time_point<ChronoClock> time_point;
+
+    static const bool is_steady = true;
+
+    static time_point now() { return fromNanos(Clock::tickNanos()); }
+
+    /** Converts a Clock time stamp (nanoseconds) to a time point. */
+    static time_point fromNanos(int64_t nanos) { return time_point(duration(nanos)); }
+
+    /** Converts a time point to a Clock time stamp (nanoseconds). */
+    static int64_t toNanos(const time_point& when) { return when.time_since_epoch().count(); }
+  };
+
+}
+
+#endif
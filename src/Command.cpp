@@ -4,6 +4,8 @@
 
 #include "Command.h"
 
+#include <algorithm>
+#include <cstring>
 #include <sstream>
 
 using namespace avc;
@@ -25,7 +27,12 @@ Command::Command(const std::string& name, float timeout) :
   _name(name),
   _timer(),
   _timeout(timeout),
-  _state(NEVER_STARTED)
+  _timeoutNanos(Timer::toNanos(timeout)),
+  _period(0),
+  _periodNanos(0),
+  _nextDueNanos(0),
+  _state(NEVER_STARTED),
+  _profile(0)
 {
   _timer.zero();
 }
@@ -43,15 +50,27 @@ void Command::doEnd(State reason) {
 
 void Command::initialize() {
   _state = STILL_RUNNING;
+  _nextDueNanos = 0;
   _timer.start();
   doInitialize();
 }
 
 Command::State Command::execute() {
-  if (_timer.secsElapsed() > getTimeout()) {
+  if (!beginExecute()) {
     return TIMED_OUT;
   }
-  return doExecute();
+
+  if (!CommandProfiler::isEnabled()) {
+    return doExecute();
+  }
+
+  if (_profile == 0) {
+    _profile = &CommandProfiler::getStats(_name);
+  }
+  int64_t start = CommandProfiler::nowNanos();
+  State state = doExecute();
+  _profile->record(CommandProfiler::nowNanos() - start);
+  return state;
 }
 
 void Command::end(State reason) {
@@ -60,23 +79,45 @@ void Command::end(State reason) {
     reason = INTERRUPTED;
   }
   _state = reason;
-  doEnd(reason);
+
+  if (CommandProfiler::isEnabled()) {
+    CommandProfiler::Scope scope(_name + ".end");
+    doEnd(reason);
+  } else {
+    doEnd(reason);
+  }
 }
 
 
 void Command::run(Command& command, int executeRateHz) {
-  Timer timer;
+  PeriodicTimer timer = PeriodicTimer::fromRate(executeRateHz);
+  run(command, timer);
+  cout << command.getName() << " ran at " << executeRateHz << " Hz: "
+       << timer << "\n";
+}
+
+void Command::run(Command& command, PeriodicTimer& timer) {
   command.initialize();
+  timer.start();
+
+  // Assume we will end due to normal termination
+  State tc = NORMAL_END;
 
-  // How long between each execution loop
-  int period = 1000000000 / executeRateHz;
+  while ((tc = executeTick(command)) == STILL_RUNNING) {
+    timer.waitForNext();
+  }
+  command.end(tc);
+}
+
+void Command::run(Command& command, PeriodicTimer& timer, Reactor& reactor) {
+  command.initialize();
+  timer.start();
 
   // Assume we will end due to normal termination
   State tc = NORMAL_END;
-  float timeout = command.getTimeout();
 
-  while ((tc = command.execute()) == STILL_RUNNING) {
-    timer.sleepUntilNextNano(period);
+  while ((tc = executeTick(command)) == STILL_RUNNING) {
+    timer.waitForNextOrEvent(reactor);
   }
   command.end(tc);
 }
@@ -94,6 +135,27 @@ std::string Command::toString() const {
   return obuf.str();
 }
 
+const Command* Command::getActiveChild() const {
+  return 0;
+}
+
+void Command::getActivePath(char* buf, int len) const {
+  if (len <= 0) {
+    return;
+  }
+  int used = 0;
+  for (const Command* cmd = this; cmd != 0; cmd = cmd->getActiveChild()) {
+    if (used > 0 && used < len - 1) {
+      buf[used++] = '/';
+    }
+    const string& name = cmd->getName();
+    int n = min((int) name.size(), len - 1 - used);
+    memcpy(buf + used, name.data(), n);
+    used += n;
+  }
+  buf[used] = '\0';
+}
+
 const string& Command::stateToString(State tc) {
   static string names[] = {
     "completed-ok", "still-running", "never-started", "was-interrupted", "timed-out", "unknown"
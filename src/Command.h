@@ -4,6 +4,8 @@
 #ifndef __avc_Command_h
 #define __avc_Command_h
 
+#include "CommandProfiler.h"
+#include "PeriodicTimer.h"
 #include "Timer.h"
 
 #include <iostream>
@@ -97,12 +99,44 @@ namespace avc {
      * @return State The state of the command (STILL_RUNNING until
      * command is done and then typically NORMAL_END). The default
      * implemetation returns NORMAL_END immediately.
+     *
+     * <p>If the CommandProfiler is enabled, the time spent in
+     * {@link #doExecute} is recorded under the name of the command.</p>
      */
     State execute();
 
+    /**
+     * Same as {@link #execute} but calls the doExecute method of the
+     * known type directly (no virtual call, so the compiler can inline
+     * it). Used by the Sequence and Parallel templates where the types
+     * of the children are fixed at compile time.
+     *
+     * <p>T::doExecute must be public. When the CommandProfiler is
+     * enabled this falls back to {@link #execute} so the time is still
+     * recorded.</p>
+     *
+     * @param command The command to execute.
+     *
+     * @return The state of the command.
+     */
+    template <class T> static State executeDirect(T& command) {
+      Command& base = command;
+      if (CommandProfiler::isEnabled()) {
+        return base.execute();
+      }
+      if (!base.beginExecute()) {
+        return TIMED_OUT;
+      }
+      return command.T::doExecute();
+    }
+
     /**
      * Called when the command has ended normally or needs to be stopped.
      *
+     * <p>If the CommandProfiler is enabled, the time spent in
+     * {@link #doEnd} is recorded under the name of the command with a
+     * ".end" suffix.</p>
+     *
      * @param reason The reason why the command is ending.
      */
     void end(State reason);
@@ -118,6 +152,48 @@ namespace avc {
      */
     static void run(Command& command, int executeRateHz = 20);
 
+    /**
+     * Executes a command as one tick of a control loop (the clock is
+     * sampled once and every command in the tree sees that time - see
+     * Clock::Tick). Used by the run methods and the simulators.
+     *
+     * @param command The root of the commands to execute.
+     *
+     * @return The state of the command.
+     */
+    static State executeTick(Command& command) {
+      Clock::Tick tick;
+      return command.execute();
+    }
+
+    /**
+     * Peforms a full execution cycle on a command (blocks until
+     * command is done) using the deadlines of a periodic timer.
+     *
+     * @param command The Command object to run through.
+     *
+     * @param timer The PeriodicTimer which determines when the {@link
+     * #execute} method should be called (it is restarted and will
+     * hold the missed deadline and lateness statistics of the run
+     * when this method returns).
+     */
+    static void run(Command& command, PeriodicTimer& timer);
+
+    /**
+     * Peforms a full execution cycle on a command (blocks until
+     * command is done) executing at each deadline of a periodic
+     * timer AND immediately after the reactor dispatches an event.
+     *
+     * @param command The Command object to run through.
+     *
+     * @param timer The PeriodicTimer which determines when the {@link
+     * #execute} method should be called.
+     *
+     * @param reactor The Reactor with the event sources the command
+     * wants to react to (like new vision frames or signals).
+     */
+    static void run(Command& command, PeriodicTimer& timer, Reactor& reactor);
+
   public:
 
     /**
@@ -138,6 +214,7 @@ namespace avc {
      */
     void setTimeout(float secs) {
       _timeout = secs;
+      _timeoutNanos = Timer::toNanos(secs);
     }
 
     /**
@@ -150,6 +227,38 @@ namespace avc {
       return _timeout;
     }
 
+    /**
+     * Set how often the command wants to be executed when run as a
+     * child of a CommandParallel.
+     *
+     * @param secs The number of seconds between each call to {@link
+     * #execute} (0 - the default - means every time the parent is
+     * executed).
+     */
+    void setPeriod(float secs) {
+      _period = secs;
+      _periodNanos = Timer::toNanos(secs);
+    }
+
+    /**
+     * Get how often the command wants to be executed (0 for every time
+     * the parent is executed).
+     */
+    float getPeriod() const {
+      return _period;
+    }
+
+    /**
+     * Determines whether enough time has elapsed since the last call
+     * to {@link #execute} that the command should be executed again.
+     *
+     * @return true if command has no period or its next period has
+     * arrived.
+     */
+    bool isDue() const {
+      return (_periodNanos <= 0) || (_timer.nanosElapsed() >= _nextDueNanos);
+    }
+
     /**
      * Returns the number of seconds elapsed since the command was
      * started or time of last run.
@@ -161,6 +270,14 @@ namespace avc {
       return _timer.secsElapsed();
     }
 
+    /**
+     * Same as {@link #getElapsedTime}, but as an exact number of
+     * nanoseconds.
+     */
+    int64_t getElapsedNanos() const {
+      return _timer.nanosElapsed();
+    }
+
     /**
      * Dumps information about the state of the command to standard output.
      *
@@ -177,6 +294,24 @@ namespace avc {
      */
     virtual std::string toString() const;
 
+    /**
+     * Returns the child command currently being run (if any).
+     *
+     * @return The active child or a null pointer if the command has
+     * no children or none are running (default implementation).
+     */
+    virtual const Command* getActiveChild() const;
+
+    /**
+     * Writes the names of this command and its chain of active
+     * children (like "Timon/Drive/MakeTurn") to a buffer (without
+     * allocating memory, safe to call on every tick).
+     *
+     * @param buf Where to write the path (always nul terminated).
+     * @param len Size of the buffer (path is truncated to fit).
+     */
+    void getActivePath(char* buf, int len) const;
+
     /**
      * Convert the current run state to a human readable string.
      */
@@ -186,6 +321,23 @@ namespace avc {
     // Disable default constructor
     Command();
 
+    // Checks for a time out and moves to the next period (returns
+    // false if the command has run out of time)
+    bool beginExecute() {
+      int64_t elapsed = _timer.nanosElapsed();
+      if (elapsed > _timeoutNanos) {
+        return false;
+      }
+
+      if (_periodNanos > 0) {
+        // Advance to next period (skipping any we were too late for)
+        while (_nextDueNanos <= elapsed) {
+          _nextDueNanos += _periodNanos;
+        }
+      }
+      return true;
+    }
+
     /** Will be null pointer until command is running. */
     Timer _timer;
 
@@ -194,9 +346,20 @@ namespace avc {
 
     /** Maximum time command ever takes to run. */
     float _timeout;
+    int64_t _timeoutNanos;
+
+    /** How often command wants to be executed (0 for every tick). */
+    float _period;
+    int64_t _periodNanos;
+
+    /** Elapsed time (nanoseconds) when command is next due to execute. */
+    int64_t _nextDueNanos;
 
     /** The current state of the command. */
     State _state;
+
+    /** Execution time statistics (null until first profiled execute). */
+    CommandProfiler::Stats* _profile;
   };
 
   //
@@ -0,0 +1,121 @@
+/**
+ * Implementation of the CommandArena class.
+ */
+
+#include "CommandArena.h"
+
+#include <algorithm>
+
+#include <stdint.h>
+
+using namespace avc;
+using namespace std;
+
+namespace {
+  // Rounds an address up to a multiple of a power of 2
+  char* alignUp(char* p, size_t align) {
+    return reinterpret_cast<char*>((reinterpret_cast<uintptr_t>(p) + align - 1) & ~(align - 1));
+  }
+}
+
+CommandArena::CommandArena(size_t blockSize) :
+  _blockSize(blockSize),
+  _capacity(0),
+  _first(0),
+  _current(0),
+  _cleanups(0)
+{
+}
+
+CommandArena::~CommandArena() {
+  reset();
+  while (_first != 0) {
+    Block* next = _first->next;
+    ::operator delete(_first);
+    _first = next;
+  }
+}
+
+char* CommandArena::take(Block* block, size_t size, size_t align) {
+  char* start = data(block);
+  char* p = alignUp(start + block->used, align);
+  if (p + size > start + block->size) {
+    return 0;
+  }
+  block->used = (p + size) - start;
+  return p;
+}
+
+void* CommandArena::allocate(size_t size, size_t align) {
+  align = (align > 0) ? align : 1;
+
+  // Move through the blocks kept from prior plans before taking more
+  for (; _current != 0; _current = _current->next) {
+    char* p = take(_current, size, align);
+    if (p != 0) {
+      return p;
+    }
+    if (_current->next == 0) {
+      break;
+    }
+  }
+
+  _current = addBlock(max(_blockSize, size + align));
+  return take(_current, size, align);
+}
+
+void CommandArena::reserve(size_t size) {
+  if (size > _capacity) {
+    Block* block = addBlock(max(_blockSize, size - _capacity));
+    if (_current == 0) {
+      _current = block;
+    }
+  }
+}
+
+CommandArena::Block* CommandArena::addBlock(size_t size) {
+  Block* block = static_cast<Block*>(::operator new(sizeof(Block) + size));
+  block->next = 0;
+  block->size = size;
+  block->used = 0;
+  _capacity += size;
+
+  if (_first == 0) {
+    _first = block;
+  } else {
+    Block* last = _first;
+    while (last->next != 0) {
+      last = last->next;
+    }
+    last->next = block;
+  }
+  return block;
+}
+
+void CommandArena::addCleanup(void* obj, void (*destroy)(void*)) {
+  Cleanup* cleanup = static_cast<Cleanup*>(allocate(sizeof(Cleanup), alignment_of<Cleanup>::value));
+  cleanup->destroy = destroy;
+  cleanup->obj = obj;
+  cleanup->prev = _cleanups;
+  _cleanups = cleanup;
+}
+
+void CommandArena::reset() {
+  while (_cleanups != 0) {
+    Cleanup* cleanup = _cleanups;
+    _cleanups = cleanup->prev;
+    cleanup->destroy(cleanup->obj);
+  }
+  for (Block* block = _first; block != 0; block = block->next) {
+    block->used = 0;
+  }
+  _current = _first;
+}
+
+size_t CommandArena::getUsed() const {
+  size_t used = 0;
+  for (Block* block = _first; block != 0; block = block->next) {
+    used += block->used;
+  }
+  return used;
+}
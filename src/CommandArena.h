@@ -0,0 +1,196 @@
+/**
+ * Definition of the CommandArena class (owns the commands of an auton
+ * plan in a few large blocks of memory).
+ */
+#ifndef __avc_CommandArena_h
+#define __avc_CommandArena_h
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace avc {
+
+  /**
+   * Bump allocator which owns the commands of an auton plan.
+   *
+   * <p>Commands are constructed one after the other in large blocks of
+   * memory (so a plan's tree ends up laid out contiguously in the order
+   * it was built). Nothing is freed on its own, {@link #reset} runs the
+   * destructors of everything made (newest first) and then reuses the
+   * same blocks. Once a plan has been built, rebuilding it never touches
+   * the heap.</p>
+   *
+   * <p>CommandSequence and CommandParallel objects constructed with an
+   * arena keep their list of children in the arena and do NOT delete
+   * the children (which must be made by the same arena).</p>
+   *
+   * <pre>
+   * CommandArena arena;
+   * CommandSequence* drive = arena.make&lt;CommandSequence&gt;("Drive", &amp;arena);
+   * drive-&gt;add(arena.make&lt;Brake&gt;(car, 1.0f));
+   *
+   * // Before building the next plan (destroys the commands above)
+   * arena.reset();
+   * </pre>
+   */
+  class CommandArena {
+
+  public:
+    /**
+     * Allocator (for standard containers) which takes its memory from
+     * an arena, or from the heap when there is no arena.
+     */
+    template <class T> class Allocator {
+    public:
+      typedef T value_type;
+      typedef T* pointer;
+      typedef const T* const_pointer;
+      typedef T& reference;
+      typedef const T& const_reference;
+      typedef std::size_t size_type;
+      typedef std::ptrdiff_t difference_type;
+
+      template <class U> struct rebind { typedef Allocator<U> other; };
+
+      Allocator(CommandArena* arena = 0) : _arena(arena) { }
+
+      template <class U> Allocator(const Allocator<U>& other) : _arena(other.getArena()) { }
+
+      T* allocate(std::size_t n, const void* hint = 0) {
+        if (_arena == 0) {
+          return static_cast<T*>(::operator new(n * sizeof(T)));
+        }
+        return static_cast<T*>(_arena->allocate(n * sizeof(T), std::alignment_of<T>::value));
+      }
+
+      // Memory taken from an arena is only given back by a reset
+      void deallocate(T* p, std::size_t n) {
+        if (_arena == 0) {
+          ::operator delete(p);
+        }
+      }
+
+      void construct(T* p, const T& val) { new (p) T(val); }
+      void destroy(T* p) { p->~T(); }
+
+      T* address(T& val) const { return &val; }
+      const T* address(const T& val) const { return &val; }
+      std::size_t max_size() const { return std::size_t(-1) / sizeof(T); }
+
+      CommandArena* getArena() const { return _arena; }
+
+    private:
+      CommandArena* _arena;
+    };
+
+    /**
+     * Constructs an empty arena (no memory is taken until the first
+     * command is made).
+     *
+     * @param blockSize Size of each block of memory taken from the
+     * heap (objects larger than this get a block of their own).
+     */
+    CommandArena(std::size_t blockSize = 16384);
+
+    /** Destroys everything made and frees the memory. */
+    ~CommandArena();
+
+    /**
+     * Constructs an object in the arena (destroyed by the next
+     * {@link #reset}).
+     *
+     * @param args The constructor arguments.
+     *
+     * @return The new object (never a null pointer).
+     */
+    template <class T, class... Args> T* make(Args&&... args) {
+      void* mem = allocate(sizeof(T), std::alignment_of<T>::value);
+      T* obj = new (mem) T(std::forward<Args>(args)...);
+      addCleanup(obj, &destroy<T>);
+      return obj;
+    }
+
+    /**
+     * Takes raw memory from the arena (not destroyed or freed until
+     * the next {@link #reset}).
+     *
+     * @param size Number of bytes needed.
+     * @param align Alignment needed (power of 2).
+     */
+    void* allocate(std::size_t size, std::size_t align);
+
+    /**
+     * Takes memory from the heap up front (so building a plan later
+     * doesn't have to).
+     *
+     * @param size Number of bytes the arena should have available
+     * (does nothing if the arena already has this much).
+     */
+    void reserve(std::size_t size);
+
+    /**
+     * Destroys everything made (newest first) and keeps the memory to
+     * build the next plan in.
+     */
+    void reset();
+
+    /** Bytes handed out since the last reset. */
+    std::size_t getUsed() const;
+
+    /** Bytes taken from the heap (kept across resets). */
+    std::size_t getCapacity() const { return _capacity; }
+
+  private:
+    CommandArena(const CommandArena&);
+    CommandArena& operator=(const CommandArena&);
+
+    struct Block {
+      Block* next;
+      std::size_t size;
+      std::size_t used;
+    };
+
+    struct Cleanup {
+      void (*destroy)(void*);
+      void* obj;
+      Cleanup* prev;
+    };
+
+    template <class T> static void destroy(void* obj) {
+      static_cast<T*>(obj)->~T();
+    }
+
+    void addCleanup(void* obj, void (*destroy)(void*));
+
+    // Takes a new block from the heap and adds it to the end of the list
+    Block* addBlock(std::size_t size);
+
+    // Carves aligned memory out of a block (null if it doesn't fit)
+    static char* take(Block* block, std::size_t size, std::size_t align);
+
+    // Memory available for objects in a block
+    static char* data(Block* block) {
+      return reinterpret_cast<char*>(block) + sizeof(Block);
+    }
+
+    std::size_t _blockSize;
+    std::size_t _capacity;
+    Block* _first;
+    Block* _current;
+    Cleanup* _cleanups;
+  };
+
+  template <class T, class U>
+  inline bool operator==(const CommandArena::Allocator<T>& a, const CommandArena::Allocator<U>& b) {
+    return a.getArena() == b.getArena();
+  }
+
+  template <class T, class U>
+  inline bool operator!=(const CommandArena::Allocator<T>& a, const CommandArena::Allocator<U>& b) {
+    return a.getArena() != b.getArena();
+  }
+}
+
+#endif
@@ -13,10 +13,12 @@ CommandParallel::~CommandParallel() {
   clear();
 }
 
-CommandParallel::CommandParallel(const std::string& name, bool stopWhenOneDone) :
+CommandParallel::CommandParallel(const std::string& name, bool stopWhenOneDone,
+                                 CommandArena* arena) :
   Command(name),
-  _commands(),
-  _states(),
+  _arena(arena),
+  _commands(CommandArena::Allocator<Command*>(arena)),
+  _states(CommandArena::Allocator<Command::State>(arena)),
   _stopWhenOneDone(stopWhenOneDone)
 {
   setTimeout(0);
@@ -29,6 +31,14 @@ void CommandParallel::add(Command* command) {
 }
 
 void CommandParallel::clear() {
+  if (_arena != 0) {
+    // Let go of the lists as well, their memory goes away when the
+    // arena is reset
+    CommandArena::Allocator<Command*> alloc(_arena);
+    std::vector<Command*, CommandArena::Allocator<Command*> >(alloc).swap(_commands);
+    std::vector<Command::State, CommandArena::Allocator<Command::State> >(alloc).swap(_states);
+    return;
+  }
   int n = _commands.size();
   for (int i = 0; i < n; i++) {
     delete _commands[i];
@@ -54,23 +64,29 @@ Command::State CommandParallel::doExecute() {
   for (int i = 0; i < n; i++) {
     // If child command is still running
     if (_states[i] == Command::STILL_RUNNING) {
+      // Skip children running at a slower rate until their period arrives
+      if (!_commands[i]->isDue()) {
+	continue;
+      }
+
       // Go execute her periodic code
-      State state = _commands[i]->execute();
-      _states[i] = state;
+      _states[i] = _commands[i]->execute();
+    }
 
-      // If terminated, update info and see if we need to stop
-      if (state != Command::STILL_RUNNING) {
-	cntDone++;
-	worstState = Command::worstState(worstState, state);
+    // If terminated, update info and see if we need to stop
+    if (_states[i] != Command::STILL_RUNNING) {
+      cntDone++;
+      worstState = Command::worstState(worstState, _states[i]);
 
-	if (_stopWhenOneDone) {
-	  break;
-	}
+      if (_stopWhenOneDone) {
+	break;
       }
     }
   }
 
-  return ((cntDone != n) ? Command::STILL_RUNNING : worstState);
+  // NOTE: Children finished on prior ticks count as done as well
+  bool done = (cntDone == n) || (_stopWhenOneDone && (cntDone > 0));
+  return (done ? worstState : Command::STILL_RUNNING);
 }
 
 void CommandParallel::doEnd(State reason) {
@@ -80,6 +96,16 @@ void CommandParallel::doEnd(State reason) {
   }
 }
 
+const Command* CommandParallel::getActiveChild() const {
+  int n = _commands.size();
+  for (int i = 0; i < n; i++) {
+    if (_states[i] == Command::STILL_RUNNING) {
+      return _commands[i];
+    }
+  }
+  return 0;
+}
+
 std::ostream& CommandParallel::print(std::ostream& out) const {
   //  Command::print(out) << "\n";
   int n = _commands.size();
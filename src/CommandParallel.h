@@ -5,6 +5,7 @@
 #define __avc_CommandParallel_h
 
 #include "Command.h"
+#include "CommandArena.h"
 
 #include <vector>
 
@@ -12,16 +13,41 @@ namespace avc {
 
   /**
    * Class which can execute 0 or more child Command objects in parallel.
+   *
+   * <p>Each time the parallel command is executed, only the children
+   * which are due (see Command::setPeriod) are executed. This allows
+   * slow or expensive children to run at a lower rate than the loop
+   * driving the parallel command.</p>
    */
   class CommandParallel : public Command {
   public:
-    CommandParallel(const std::string& name, bool stopWhenOneDone = false);
+    /**
+     * Constructs an empty parallel command.
+     *
+     * @param name Name of the command.
+     * @param stopWhenOneDone Set to stop as soon as any child is done.
+     * @param arena Arena which owns the children (and holds the list of
+     * them) or a null pointer if the parallel command deletes its
+     * children.
+     */
+    CommandParallel(const std::string& name, bool stopWhenOneDone = false,
+                    CommandArena* arena = 0);
     ~CommandParallel();
 
     void add(Command* command);
 
+    /**
+     * Removes all of the children (deleting them unless they are owned
+     * by an arena - clear BEFORE resetting the arena).
+     */
     void clear();
 
+    /**
+     * Returns the first child still running (typically the drive
+     * sequence as it is added first).
+     */
+    const Command* getActiveChild() const;
+
   protected:
     void doInitialize();
     State doExecute();
@@ -29,8 +55,9 @@ namespace avc {
     std::ostream& print(std::ostream& out) const;
 
   private:
-    std::vector<Command*> _commands;
-    std::vector<Command::State> _states;
+    CommandArena* _arena;
+    std::vector<Command*, CommandArena::Allocator<Command*> > _commands;
+    std::vector<Command::State, CommandArena::Allocator<Command::State> > _states;
     bool _stopWhenOneDone;
   };
 }
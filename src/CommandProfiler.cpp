@@ -0,0 +1,127 @@
+/**
+ * Implementation of the CommandProfiler class.
+ */
+
+#include "CommandProfiler.h"
+
+#include <algorithm>
+#include <iomanip>
+
+using namespace avc;
+using namespace std;
+
+namespace {
+  // Size of the reservoir of samples kept for percentiles
+  const size_t maxSamples = 2048;
+
+  // Largest sample we can store (just over 4 seconds)
+  const int64_t maxSample = 0xffffffffLL;
+
+  inline double toMicros(int64_t nanos) {
+    return nanos / 1000.0;
+  }
+}
+
+bool CommandProfiler::_enabled = false;
+map<string, CommandProfiler::Stats> CommandProfiler::_stats;
+
+CommandProfiler::Stats::Stats() :
+  _samples(),
+  _count(0),
+  _random(2463534242u),
+  _sum(0),
+  _min(0),
+  _max(0)
+{
+  _samples.reserve(maxSamples);
+}
+
+void CommandProfiler::Stats::record(int64_t nanos) {
+  nanos = max((int64_t) 0, min(maxSample, nanos));
+  if ((_count == 0) || (nanos < _min)) {
+    _min = nanos;
+  }
+  if (nanos > _max) {
+    _max = nanos;
+  }
+  _sum += nanos;
+  _count++;
+
+  if (_samples.size() < maxSamples) {
+    _samples.push_back((uint32_t) nanos);
+    return;
+  }
+
+  // Reservoir is full, replace a slot with probability maxSamples/_count
+  // (xorshift keeps this cheap and deterministic)
+  _random ^= _random << 13;
+  _random ^= _random >> 17;
+  _random ^= _random << 5;
+  uint32_t slot = _random % (uint32_t) _count;
+  if (slot < maxSamples) {
+    _samples[slot] = (uint32_t) nanos;
+  }
+}
+
+void CommandProfiler::Stats::clear() {
+  _samples.clear();
+  _count = 0;
+  _sum = _min = _max = 0;
+}
+
+int64_t CommandProfiler::Stats::getMean() const {
+  int n = getCount();
+  return (n > 0) ? (_sum / n) : 0;
+}
+
+int64_t CommandProfiler::Stats::getPercentile(float pct) const {
+  int n = (int) _samples.size();
+  if (n == 0) {
+    return 0;
+  }
+  int idx = (int) ((pct / 100.0f) * (n - 1) + 0.5f);
+  idx = max(0, min(n - 1, idx));
+
+  vector<uint32_t> sorted(_samples);
+  nth_element(sorted.begin(), sorted.begin() + idx, sorted.end());
+  return sorted[idx];
+}
+
+CommandProfiler::Stats& CommandProfiler::getStats(const string& name) {
+  return _stats[name];
+}
+
+ostream& CommandProfiler::dump(ostream& out) {
+  out << "Command execution times (microseconds):\n"
+      << setw(24) << left << "name" << right
+      << setw(8) << "calls"
+      << setw(10) << "min"
+      << setw(10) << "mean"
+      << setw(10) << "p99"
+      << setw(10) << "max" << "\n";
+
+  ios::fmtflags flags = out.flags();
+  out << fixed << setprecision(1);
+
+  for (map<string, Stats>::const_iterator it = _stats.begin(); it != _stats.end(); ++it) {
+    const Stats& s = it->second;
+    if (s.getCount() == 0) {
+      continue;
+    }
+    out << setw(24) << left << it->first << right
+        << setw(8) << s.getCount()
+        << setw(10) << toMicros(s.getMin())
+        << setw(10) << toMicros(s.getMean())
+        << setw(10) << toMicros(s.getPercentile(99.0f))
+        << setw(10) << toMicros(s.getMax()) << "\n";
+  }
+
+  out.flags(flags);
+  return out;
+}
+
+void CommandProfiler::clear() {
+  for (map<string, Stats>::iterator it = _stats.begin(); it != _stats.end(); ++it) {
+    it->second.clear();
+  }
+}
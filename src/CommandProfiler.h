@@ -0,0 +1,170 @@
+/**
+ * Definition of the CommandProfiler used to measure execution times.
+ */
+#ifndef __avc_CommandProfiler_h
+#define __avc_CommandProfiler_h
+
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+#include <time.h>
+
+namespace avc {
+
+  /**
+   * Opt-in profiler which collects wall clock execution times of
+   * Command objects (keyed by command name).
+   *
+   * <p>When enabled, Command::execute records the time spent in each
+   * doExecute call. Times are inclusive (a CommandSequence includes
+   * the time of the child command it is running).</p>
+   *
+   * <pre>
+   * CommandProfiler::setEnabled(true);
+   * Command::run(timon);
+   * CommandProfiler::dump(cout);
+   * </pre>
+   */
+  class CommandProfiler {
+
+  public:
+    /**
+     * Statistics collected for a single name.
+     *
+     * <p>The min, max and mean cover every call. Percentiles are
+     * computed from a fixed size reservoir (a uniform random sample of
+     * the calls), so recording never allocates memory no matter how
+     * long the run is.</p>
+     */
+    class Stats {
+
+    public:
+      Stats();
+
+      /**
+       * Adds a new sample.
+       *
+       * @param nanos How long the call took (in nanoseconds).
+       */
+      void record(int64_t nanos);
+
+      /**
+       * Clears all samples.
+       */
+      void clear();
+
+      /** Number of samples recorded. */
+      int getCount() const { return _count; }
+
+      /** Smallest sample (nanoseconds). */
+      int64_t getMin() const { return _min; }
+
+      /** Largest sample (nanoseconds). */
+      int64_t getMax() const { return _max; }
+
+      /** Average of all samples (nanoseconds). */
+      int64_t getMean() const;
+
+      /**
+       * Computes a percentile value (like 99.0 for p99) from the
+       * reservoir of samples.
+       *
+       * @param pct Percentile in the range of [0, 100].
+       *
+       * @return The sample value (nanoseconds) at the percentile.
+       */
+      int64_t getPercentile(float pct) const;
+
+    private:
+      // Reservoir of samples (never grows past its initial capacity)
+      std::vector<uint32_t> _samples;
+      int _count;
+      uint32_t _random;
+      int64_t _sum;
+      int64_t _min;
+      int64_t _max;
+    };
+
+    /**
+     * Helper to time a block of code which is not a Command (stops
+     * timing and records when it goes out of scope).
+     *
+     * <pre>
+     * {
+     *   CommandProfiler::Scope scope("Timon.readSensors");
+     *   readSensors();
+     * }
+     * </pre>
+     */
+    class Scope {
+
+    public:
+      Scope(const char* name) :
+        _stats(isEnabled() ? &getStats(name) : 0),
+        _start(_stats ? nowNanos() : 0) {
+      }
+
+      Scope(const std::string& name) :
+        _stats(isEnabled() ? &getStats(name) : 0),
+        _start(_stats ? nowNanos() : 0) {
+      }
+
+      ~Scope() {
+        if (_stats) {
+          _stats->record(nowNanos() - _start);
+        }
+      }
+
+    private:
+      Stats* _stats;
+      int64_t _start;
+    };
+
+    /**
+     * Turn profiling on or off (off by default).
+     */
+    static void setEnabled(bool enabled) { _enabled = enabled; }
+
+    /**
+     * Returns true if profiling is turned on.
+     */
+    static bool isEnabled() { return _enabled; }
+
+    /**
+     * Gets (creating if necessary) the statistics for a name.
+     *
+     * <p>The reference returned remains valid for the life of the
+     * program so callers can cache it.</p>
+     */
+    static Stats& getStats(const std::string& name);
+
+    /**
+     * Dumps a table of all collected statistics (times in microseconds).
+     */
+    static std::ostream& dump(std::ostream& out);
+
+    /**
+     * Clears all of the collected samples (names are retained).
+     */
+    static void clear();
+
+    /**
+     * Gets a time stamp (in nanoseconds) suitable for computing durations.
+     */
+    static int64_t nowNanos() {
+      timespec now;
+      clock_gettime(CLOCK_MONOTONIC, &now);
+      return now.tv_sec * 1000000000LL + now.tv_nsec;
+    }
+
+  private:
+    static bool _enabled;
+    static std::map<std::string, Stats> _stats;
+  };
+
+}
+
+#endif
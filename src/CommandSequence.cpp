@@ -10,15 +10,19 @@ using namespace avc;
 using namespace std;
 
 CommandSequence::~CommandSequence() {
+  if (_arena != 0) {
+    return;
+  }
   int n = _commands.size();
   for (int i = 0; i < n; i++) {
     delete _commands[i];
   }
 }
 
-CommandSequence::CommandSequence(const std::string& name) :
+CommandSequence::CommandSequence(const std::string& name, CommandArena* arena) :
   Command(name),
-  _commands(),
+  _arena(arena),
+  _commands(CommandArena::Allocator<Command*>(arena)),
   _currentIdx(0)
 {
   setTimeout(0);
@@ -93,3 +97,7 @@ std::ostream& CommandSequence::print(std::ostream& out) const {
   }
   return out;
 }
+
+const Command* CommandSequence::getActiveChild() const {
+  return (_currentIdx < (int) _commands.size()) ? _commands[_currentIdx] : 0;
+}
@@ -5,6 +5,7 @@
 #define __avc_CommandSequence_h
 
 #include "Command.h"
+#include "CommandArena.h"
 
 #include <vector>
 
@@ -12,11 +13,19 @@ namespace avc {
 
   class CommandSequence : public Command {
   public:
-    CommandSequence(const std::string& name);
+    /**
+     * Constructs an empty sequence.
+     *
+     * @param name Name of the command.
+     * @param arena Arena which owns the children (and holds the list of
+     * them) or a null pointer if the sequence deletes its children.
+     */
+    CommandSequence(const std::string& name, CommandArena* arena = 0);
     ~CommandSequence();
 
     void add(Command* command);
     std::ostream& print(std::ostream& out) const;
+    const Command* getActiveChild() const;
 
   protected:
     void doInitialize();
@@ -24,7 +33,8 @@ namespace avc {
     void doEnd(State reason);
 
   private:
-    std::vector<Command*> _commands;
+    CommandArena* _arena;
+    std::vector<Command*, CommandArena::Allocator<Command*> > _commands;
     int _currentIdx;
     bool _needInitialize;
   };
@@ -0,0 +1,313 @@
+/**
+ * Definition of the Sequence and Parallel templates (compile time
+ * versions of CommandSequence and CommandParallel).
+ */
+#ifndef __avc_CommandTemplates_h
+#define __avc_CommandTemplates_h
+
+#include "Command.h"
+
+#include <algorithm>
+#include <iostream>
+#include <tuple>
+#include <type_traits>
+
+namespace avc {
+
+  /**
+   * Runs a fixed list of commands one after the other (like
+   * CommandSequence) where the types of the commands are known at
+   * compile time.
+   *
+   * <p>The children are held by value in a std::tuple and executed
+   * through Command::executeDirect, so each tick is a chain of direct
+   * (inlinable) calls instead of a virtual call per level of the
+   * tree. A Sequence is still a Command, so it can be added to a
+   * CommandSequence or CommandParallel, nested in other templates or
+   * run by Command::run. The doExecute method of each child type must
+   * be public.</p>
+   *
+   * <pre>
+   * auto drive = makeSequence("Drive",
+   *                           DrivePowerTime(car, 0, 0, 0.25),
+   *                           DriveStraight(car, 0, 2.0, false),
+   *                           Brake(car, 1.0));
+   * </pre>
+   */
+  template <class... Cs> class Sequence : public Command {
+    static_assert(sizeof...(Cs) > 0, "A Sequence needs at least one command");
+
+  public:
+    /** Number of children. */
+    static const int SIZE = sizeof...(Cs);
+
+    /**
+     * Constructs a sequence (timeout is the sum of the timeouts of the
+     * children).
+     *
+     * @param name Name of the command.
+     * @param children The commands to run (copied or moved in).
+     */
+    Sequence(const std::string& name, Cs... children) :
+      Command(name),
+      _children(std::move(children)...),
+      _currentIdx(0),
+      _needInitialize(true)
+    {
+      setTimeout(sumTimeouts<0>());
+    }
+
+    void doInitialize() {
+      _currentIdx = 0;
+      _needInitialize = true;
+    }
+
+    State doExecute() {
+      State state = Command::NORMAL_END;
+
+      while (_currentIdx < SIZE) {
+        if (_needInitialize) {
+          _needInitialize = false;
+          getChild(_currentIdx)->initialize();
+          std::cout << "Seq initialized: " << *this << "\n";
+        }
+
+        state = executeAt<0>(_currentIdx);
+        if (state == Command::STILL_RUNNING) {
+          break;
+        }
+        getChild(_currentIdx)->end(state);
+        std::cout << "Seq ended: " << *this << "\n";
+
+        if (state != Command::NORMAL_END) {
+          break;
+        }
+
+        // Command ended normally, move to next command in list
+        _needInitialize = true;
+        _currentIdx++;
+      }
+      return state;
+    }
+
+    void doEnd(State reason) {
+      if (_currentIdx < SIZE) {
+        // If we had a child command running, then end it
+        getChild(_currentIdx)->end(reason);
+      }
+      // Move index past end so we don't start any new commands
+      _currentIdx = SIZE;
+      _needInitialize = true;
+    }
+
+    const Command* getActiveChild() const {
+      return (_currentIdx < SIZE) ? getChild(_currentIdx) : 0;
+    }
+
+    std::ostream& print(std::ostream& out) const {
+      out << getName() << '[' << _currentIdx << " of " << SIZE << "]";
+      if (_currentIdx < SIZE) {
+        out << " = " << *getChild(_currentIdx);
+      }
+      return out;
+    }
+
+    /** Direct access to a child (in the order passed in). */
+    template <int I> typename std::tuple_element<I, std::tuple<Cs...> >::type& get() {
+      return std::get<I>(_children);
+    }
+
+  private:
+    template <int I> typename std::enable_if<(I < SIZE), State>::type executeAt(int i) {
+      return (i == I) ? Command::executeDirect(std::get<I>(_children)) : executeAt<I + 1>(i);
+    }
+    template <int I> typename std::enable_if<(I >= SIZE), State>::type executeAt(int i) {
+      return Command::NORMAL_END;
+    }
+
+    template <int I> typename std::enable_if<(I < SIZE), const Command*>::type childAt(int i) const {
+      return (i == I) ? &std::get<I>(_children) : childAt<I + 1>(i);
+    }
+    template <int I> typename std::enable_if<(I >= SIZE), const Command*>::type childAt(int i) const {
+      return 0;
+    }
+
+    template <int I> typename std::enable_if<(I < SIZE), float>::type sumTimeouts() const {
+      return std::get<I>(_children).getTimeout() + sumTimeouts<I + 1>();
+    }
+    template <int I> typename std::enable_if<(I >= SIZE), float>::type sumTimeouts() const {
+      return 0;
+    }
+
+    // Child by index (initialize/end/print are once per child, the
+    // virtual calls don't matter there)
+    const Command* getChild(int i) const { return childAt<0>(i); }
+    Command* getChild(int i) { return const_cast<Command*>(childAt<0>(i)); }
+
+    std::tuple<Cs...> _children;
+    int _currentIdx;
+    bool _needInitialize;
+  };
+
+  /**
+   * Runs a fixed list of commands in parallel (like CommandParallel)
+   * where the types of the commands are known at compile time.
+   *
+   * <p>Same as CommandParallel, only the children which are due (see
+   * Command::setPeriod) are executed each tick. See Sequence for how
+   * the children are held and dispatched.</p>
+   *
+   * <pre>
+   * auto timon = makeParallel("Timon", true, drive, StatusLeds(car));
+   * </pre>
+   */
+  template <class... Cs> class Parallel : public Command {
+    static_assert(sizeof...(Cs) > 0, "A Parallel needs at least one command");
+
+  public:
+    /** Number of children. */
+    static const int SIZE = sizeof...(Cs);
+
+    /**
+     * Constructs a parallel command (timeout is the longest timeout of
+     * the children).
+     *
+     * @param name Name of the command.
+     * @param stopWhenOneDone Set to stop as soon as any child is done.
+     * @param children The commands to run (copied or moved in).
+     */
+    Parallel(const std::string& name, bool stopWhenOneDone, Cs... children) :
+      Command(name),
+      _children(std::move(children)...),
+      _stopWhenOneDone(stopWhenOneDone)
+    {
+      std::fill(_states, _states + SIZE, Command::NEVER_STARTED);
+      setTimeout(maxTimeout<0>());
+    }
+
+    void doInitialize() {
+      for (int i = 0; i < SIZE; i++) {
+        _states[i] = Command::STILL_RUNNING;
+        getChild(i)->initialize();
+      }
+    }
+
+    State doExecute() {
+      State worstState = Command::NORMAL_END;
+      int cntDone = 0;
+      executeFrom<0>(worstState, cntDone);
+
+      // NOTE: Children finished on prior ticks count as done as well
+      bool done = (cntDone == SIZE) || (_stopWhenOneDone && (cntDone > 0));
+      return (done ? worstState : Command::STILL_RUNNING);
+    }
+
+    void doEnd(State reason) {
+      for (int i = 0; i < SIZE; i++) {
+        getChild(i)->end(reason);
+      }
+    }
+
+    /** Returns the first child still running. */
+    const Command* getActiveChild() const {
+      for (int i = 0; i < SIZE; i++) {
+        if (_states[i] == Command::STILL_RUNNING) {
+          return getChild(i);
+        }
+      }
+      return 0;
+    }
+
+    std::ostream& print(std::ostream& out) const {
+      int running = 0;
+      for (int i = 0; i < SIZE; i++) {
+        if (_states[i] == Command::STILL_RUNNING) {
+          running++;
+        }
+      }
+      out << getName() << '[' << running << " running of " << SIZE << "]: {";
+      for (int i = 0; i < SIZE; i++) {
+        if (_states[i] == Command::STILL_RUNNING) {
+          out << " " << getChild(i)->getName();
+        }
+      }
+      return out << " }";
+    }
+
+    /** Direct access to a child (in the order passed in). */
+    template <int I> typename std::tuple_element<I, std::tuple<Cs...> >::type& get() {
+      return std::get<I>(_children);
+    }
+
+  private:
+    // Executes the children from I on (stops early if one is done and
+    // only one needs to be)
+    template <int I> typename std::enable_if<(I < SIZE), void>::type
+    executeFrom(State& worstState, int& cntDone) {
+      // If child command is still running
+      if (_states[I] == Command::STILL_RUNNING) {
+        typename std::tuple_element<I, std::tuple<Cs...> >::type& child = std::get<I>(_children);
+
+        // Skip children running at a slower rate until their period arrives
+        if (!child.isDue()) {
+          executeFrom<I + 1>(worstState, cntDone);
+          return;
+        }
+        _states[I] = Command::executeDirect(child);
+      }
+
+      // If terminated, update info and see if we need to stop
+      if (_states[I] != Command::STILL_RUNNING) {
+        cntDone++;
+        worstState = Command::worstState(worstState, _states[I]);
+
+        if (_stopWhenOneDone) {
+          return;
+        }
+      }
+      executeFrom<I + 1>(worstState, cntDone);
+    }
+    template <int I> typename std::enable_if<(I >= SIZE), void>::type
+    executeFrom(State& worstState, int& cntDone) {
+    }
+
+    template <int I> typename std::enable_if<(I < SIZE), const Command*>::type childAt(int i) const {
+      return (i == I) ? &std::get<I>(_children) : childAt<I + 1>(i);
+    }
+    template <int I> typename std::enable_if<(I >= SIZE), const Command*>::type childAt(int i) const {
+      return 0;
+    }
+
+    template <int I> typename std::enable_if<(I < SIZE), float>::type maxTimeout() const {
+      return std::max(std::get<I>(_children).getTimeout(), maxTimeout<I + 1>());
+    }
+    template <int I> typename std::enable_if<(I >= SIZE), float>::type maxTimeout() const {
+      return 0;
+    }
+
+    const Command* getChild(int i) const { return childAt<0>(i); }
+    Command* getChild(int i) { return const_cast<Command*>(childAt<0>(i)); }
+
+    std::tuple<Cs...> _children;
+    Command::State _states[sizeof...(Cs)];
+    bool _stopWhenOneDone;
+  };
+
+  /**
+   * Builds a Sequence (deduces the types of the children).
+   */
+  template <class... Cs>
+  inline Sequence<Cs...> makeSequence(const std::string& name, Cs... children) {
+    return Sequence<Cs...>(name, std::move(children)...);
+  }
+
+  /**
+   * Builds a Parallel (deduces the types of the children).
+   */
+  template <class... Cs>
+  inline Parallel<Cs...> makeParallel(const std::string& name, bool stopWhenOneDone, Cs... children) {
+    return Parallel<Cs...>(name, stopWhenOneDone, std::move(children)...);
+  }
+}
+
+#endif
@@ -0,0 +1,99 @@
+/**
+ * Definition of the vision record shared between avc-vision and avc.
+ */
+
+#ifndef __avc_FileData_h
+#define __avc_FileData_h
+
+#include <cstring>
+
+#include <stdint.h>
+
+enum Found: int {
+    None,
+        Red,
+        Yellow,
+        };
+
+/**
+ * Record avc-vision publishes (to /dev/shm/stanchions) after each
+ * frame is processed.
+ *
+ * <p>The two frame counts act as a sequence lock. A writer must store
+ * frameCount first, then the payload, then safetyFrameCount (with
+ * release ordering). A reader loads safetyFrameCount (with acquire
+ * ordering) before copying the payload and frameCount after it. The
+ * copy is only consistent if the two counts match.</p>
+ */
+struct FileData {
+    int frameCount; 
+    Found found;
+
+    int boxWidth, boxHeight;
+    int xMid, yBot;
+
+    int safetyFrameCount;
+
+    // Zeros contents (which results in Found::None)
+    void clear() { memset((char*) this, 0, sizeof(FileData)); }
+
+    // Let constructor clear contents
+    FileData() { clear(); }
+};
+
+/**
+ * A FileData record along with the time it was captured.
+ */
+struct VisionFrame {
+    // CLOCK_MONOTONIC time stamp (nanoseconds) when frame was captured
+    int64_t timeNanos;
+    FileData data;
+};
+
+/**
+ * Layout of the shared memory file when avc-vision publishes every
+ * frame (not just the latest) in a single producer, single consumer
+ * ring.
+ *
+ * <p>The latest record is kept at the start of the file so readers
+ * which only want the most recent frame (and older versions of avc)
+ * continue to work.</p>
+ *
+ * <p>Each slot has its own sequence number. To publish frame N (the
+ * (N + 1)th frame) a writer stores 2N + 1 into the sequence of slot
+ * N % CAPACITY, stores the frame, stores 2N + 2 into the sequence
+ * (release) and finally stores N + 1 into head (release). A reader
+ * which has fallen more than CAPACITY frames behind will see a
+ * sequence number it does not expect and knows the frame was
+ * lost.</p>
+ */
+struct VisionRing {
+    // Value of magic once a writer has initialized the ring
+    static const uint32_t MAGIC = 0x41564352;
+
+    // Number of frames the ring holds (about 2 seconds at 30 FPS)
+    static const uint32_t CAPACITY = 64;
+
+    // NOTE: 32 bit counters so loads are single instructions on the
+    // BBB (wraps after about 2 years of continuous 30 FPS frames)
+    struct Slot {
+        uint32_t seq;
+        VisionFrame frame;
+    };
+
+    // Most recently published record (same as single record layout)
+    FileData latest;
+
+    // MAGIC if ring is valid
+    uint32_t magic;
+
+    // Number of slots (CAPACITY)
+    uint32_t capacity;
+
+    // Total number of frames ever published
+    uint32_t head;
+
+    Slot slots[CAPACITY];
+};
+
+#endif
@@ -0,0 +1,84 @@
+/**
+ * Implementation of the FlightRecord structure and FlightRecorder class.
+ */
+
+#include "FlightRecorder.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+using namespace avc;
+using namespace std;
+
+//
+// FlightRecord methods
+//
+
+ostream& FlightRecord::print(ostream& out) const {
+  out << "tick=" << tick << " late=" << (lateNanos / 1000) << "us missed=" << missed
+      << " " << path << "  Timon(left=" << left << ", right=" << right
+      << ", heading=" << heading << ", frameCount=" << vision.frameCount
+      << ", found=" << vision.found << ", box=" << vision.boxWidth << "x" << vision.boxHeight
+      << ", xMid=" << vision.xMid << ", yBot=" << vision.yBot
+      << ", inTurn=" << (int) inTurn << ")";
+  if (crashed) {
+    out << " CRASHED";
+  }
+  return out;
+}
+
+//
+// FlightRecorder methods
+//
+
+FlightRecorder::FlightRecorder() :
+  _log(0)
+{
+}
+
+FlightRecorder::~FlightRecorder() {
+  close();
+}
+
+bool FlightRecorder::open(const string& path) {
+  close();
+
+  int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (fd < 0) {
+    cerr << "WARNING: Unable to open flight recorder file: " << path << "\n";
+    return false;
+  }
+
+  // Allocate all of the blocks now so a full disk shows up here and
+  // not as a SIGBUS in the middle of a run
+  int err = posix_fallocate(fd, 0, sizeof(FlightLog));
+  if (err != 0) {
+    cerr << "WARNING: Unable to size flight recorder file: " << path << "\n";
+    ::close(fd);
+    return false;
+  }
+
+  void* mem = mmap(0, sizeof(FlightLog), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  ::close(fd);
+
+  if (mem == MAP_FAILED) {
+    cerr << "WARNING: Unable to map flight recorder file: " << path << "\n";
+    return false;
+  }
+
+  _log = static_cast<FlightLog*>(mem);
+  _log->recordSize = sizeof(FlightRecord);
+  _log->capacity = FlightLog::CAPACITY;
+  _log->head = 0;
+  __atomic_store_n(&_log->magic, FlightLog::MAGIC, __ATOMIC_RELEASE);
+  return true;
+}
+
+void FlightRecorder::close() {
+  if (_log != 0) {
+    msync(_log, sizeof(FlightLog), MS_ASYNC);
+    munmap(_log, sizeof(FlightLog));
+    _log = 0;
+  }
+}
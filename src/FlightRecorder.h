@@ -0,0 +1,143 @@
+/**
+ * Definition of the FlightRecord structure and FlightRecorder class.
+ */
+#ifndef __avc_FlightRecorder_h
+#define __avc_FlightRecorder_h
+
+#include "FileData.h"
+
+#include <iostream>
+#include <string>
+
+#include <stdint.h>
+
+namespace avc {
+
+  /**
+   * State of the vehicle at the end of a single control loop tick.
+   */
+  struct FlightRecord {
+    // Maximum length of the command path stored (always nul terminated)
+    static const int PATH_LEN = 48;
+
+    // CLOCK_MONOTONIC time (nanoseconds) record was made
+    int64_t timeNanos;
+    // How late the tick started after its deadline (nanoseconds)
+    int64_t lateNanos;
+    // Tick number within the run (from the PeriodicTimer)
+    int32_t tick;
+    // Total deadlines missed so far in the run
+    int32_t missed;
+    // Heading of the car and power applied to each side
+    float heading;
+    float left;
+    float right;
+    // Set if the car considers itself crashed
+    uint8_t crashed;
+    // Set while in a turn
+    uint8_t inTurn;
+    uint8_t reserved[2];
+    // Latest vision record
+    FileData vision;
+    // Active command path (like "Timon/Drive/MakeTurn")
+    char path[PATH_LEN];
+
+    /**
+     * Prints a text version of the record.
+     */
+    std::ostream& print(std::ostream& out) const;
+  };
+
+  /**
+   * Layout of the flight recorder file (a header followed by a fixed
+   * size circular array of records).
+   */
+  struct FlightLog {
+    // Identifies a flight recorder file
+    static const uint32_t MAGIC = 0x52464641;
+
+    // Number of records kept (about 6 minutes at 20 Hz)
+    static const uint32_t CAPACITY = 8192;
+
+    uint32_t magic;
+    uint32_t recordSize;
+    uint32_t capacity;
+    // Total records ever added (next slot is head % capacity)
+    uint32_t head;
+
+    FlightRecord records[CAPACITY];
+  };
+
+  /**
+   * Keeps the last several minutes of FlightRecord entries in a memory
+   * mapped file.
+   *
+   * <p>Adding a record is just a memcpy into the mapped page followed
+   * by a store of the head count (no system calls). The pages belong
+   * to the kernel's page cache, so whatever we've added makes it to
+   * disk even if the process crashes or is killed (only losing power
+   * before the kernel writes the pages back loses records). Use the
+   * avc-flight tool to dump the last few seconds of a run.</p>
+   *
+   * <pre>
+   * FlightRecorder recorder;
+   * recorder.open("/var/log/avc/avc-flight.bin");
+   *
+   * FlightRecord rec;
+   * fillIn(rec);
+   * recorder.add(rec);
+   * </pre>
+   */
+  class FlightRecorder {
+
+  public:
+    FlightRecorder();
+
+    /** Unmaps the file. */
+    ~FlightRecorder();
+
+    /**
+     * Creates (or resets) the flight recorder file and maps it into memory.
+     *
+     * @param path The file to keep records in.
+     *
+     * @return true if file was created and mapped.
+     */
+    bool open(const std::string& path);
+
+    /** Schedules a write back of the records and unmaps the file. */
+    void close();
+
+    /** Returns true if the file is mapped. */
+    bool isOpen() const { return _log != 0; }
+
+    /**
+     * Copies a record into the next slot (overwriting the oldest
+     * record once the file is full).
+     */
+    void add(const FlightRecord& rec) {
+      if (_log != 0) {
+        uint32_t head = _log->head;
+        _log->records[head % FlightLog::CAPACITY] = rec;
+        // Record must be complete before the extractor can see it
+        __atomic_store_n(&_log->head, head + 1, __ATOMIC_RELEASE);
+      }
+    }
+
+    /** Total number of records added since opened. */
+    uint32_t getAdded() const { return (_log != 0) ? _log->head : 0; }
+
+  private:
+    FlightRecorder(const FlightRecorder&);
+    FlightRecorder& operator=(const FlightRecorder&);
+
+    FlightLog* _log;
+  };
+
+  inline std::ostream& operator<<(std::ostream& out, const FlightRecord& rec) {
+    return rec.print(out);
+  }
+
+}
+
+#endif
@@ -0,0 +1,290 @@
+/**
+ * Implementation of Image and the FrameSource classes.
+ */
+
+#include "FrameSource.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/videodev2.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+
+using namespace avc;
+using namespace std;
+
+namespace {
+  const int numCaptureBuffers = 4;
+
+  int64_t nowNanos() {
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000000000LL + now.tv_nsec;
+  }
+
+  // Reads next integer in PPM header (skipping white space and comments)
+  bool readPpmInt(FILE* in, int& val) {
+    int c = fgetc(in);
+    while ((c == '#') || isspace(c)) {
+      if (c == '#') {
+        while ((c != '\n') && (c != EOF)) {
+          c = fgetc(in);
+        }
+      }
+      c = fgetc(in);
+    }
+    ungetc(c, in);
+    return fscanf(in, "%d", &val) == 1;
+  }
+
+  inline uint8_t clampByte(int v) {
+    return (uint8_t) ((v < 0) ? 0 : ((v > 255) ? 255 : v));
+  }
+
+  // Retry ioctl if interrupted by a signal
+  int xioctl(int fd, unsigned long request, void* arg) {
+    int rc;
+    do {
+      rc = ioctl(fd, request, arg);
+    } while ((rc == -1) && (errno == EINTR));
+    return rc;
+  }
+}
+
+//
+// Image class
+//
+
+bool Image::loadPpm(const string& path) {
+  FILE* in = fopen(path.c_str(), "rb");
+  if (in == 0) {
+    return false;
+  }
+
+  int w = 0, h = 0, maxVal = 0;
+  bool ok = (fgetc(in) == 'P') && (fgetc(in) == '6') &&
+    readPpmInt(in, w) && readPpmInt(in, h) && readPpmInt(in, maxVal) &&
+    (w > 0) && (h > 0) && (maxVal == 255) && isspace(fgetc(in));
+
+  if (ok) {
+    resize(w, h);
+    ok = (fread(&rgb[0], 1, rgb.size(), in) == rgb.size());
+  }
+  fclose(in);
+  return ok;
+}
+
+bool Image::savePpm(const string& path) const {
+  FILE* out = fopen(path.c_str(), "wb");
+  if (out == 0) {
+    return false;
+  }
+  fprintf(out, "P6\n%d %d\n255\n", width, height);
+  bool ok = (fwrite(&rgb[0], 1, rgb.size(), out) == rgb.size());
+  return (fclose(out) == 0) && ok;
+}
+
+//
+// DirectorySource class
+//
+
+DirectorySource::DirectorySource(const string& dir, bool preload, int loops) :
+  _files(),
+  _images(),
+  _loops(loops),
+  _idx(0)
+{
+  DIR* d = opendir(dir.c_str());
+  if (d == 0) {
+    cerr << "***ERROR*** Unable to open image directory: " << dir << "\n";
+    return;
+  }
+
+  dirent* ent;
+  while ((ent = readdir(d)) != 0) {
+    string name(ent->d_name);
+    if ((name.size() > 4) && (name.compare(name.size() - 4, 4, ".ppm") == 0)) {
+      _files.push_back(dir + "/" + name);
+    }
+  }
+  closedir(d);
+  sort(_files.begin(), _files.end());
+
+  if (preload) {
+    _images.resize(_files.size());
+    for (size_t i = 0; i < _files.size(); i++) {
+      if (!_images[i].loadPpm(_files[i])) {
+        cerr << "WARNING: Unable to load: " << _files[i] << "\n";
+      }
+    }
+  }
+}
+
+bool DirectorySource::next(Image& img, int64_t& timeNanos) {
+  while (_loops > 0) {
+    if (_idx >= _files.size()) {
+      _idx = 0;
+      if ((--_loops <= 0) || _files.empty()) {
+        break;
+      }
+    }
+
+    size_t i = _idx++;
+    bool ok = _images.empty() ? img.loadPpm(_files[i]) : (_images[i].width > 0);
+    if (ok) {
+      if (!_images.empty()) {
+        img = _images[i];
+      }
+      timeNanos = nowNanos();
+      return true;
+    }
+  }
+  return false;
+}
+
+//
+// V4l2Source class
+//
+
+V4l2Source::V4l2Source(const string& device, int width, int height) :
+  _fd(::open(device.c_str(), O_RDWR | O_CLOEXEC)),
+  _width(width),
+  _height(height),
+  _buffers()
+{
+  if (_fd < 0) {
+    cerr << "***ERROR*** Unable to open camera: " << device << "\n";
+    return;
+  }
+
+  v4l2_format fmt;
+  memset(&fmt, 0, sizeof(fmt));
+  fmt.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+  fmt.fmt.pix.width = width;
+  fmt.fmt.pix.height = height;
+  fmt.fmt.pix.pixelformat = V4L2_PIX_FMT_YUYV;
+  fmt.fmt.pix.field = V4L2_FIELD_NONE;
+
+  if ((xioctl(_fd, VIDIOC_S_FMT, &fmt) != 0) ||
+      (fmt.fmt.pix.pixelformat != V4L2_PIX_FMT_YUYV)) {
+    cerr << "***ERROR*** Camera does not support YUYV frames: " << device << "\n";
+    close();
+    return;
+  }
+  // Driver may have picked a different size
+  _width = fmt.fmt.pix.width;
+  _height = fmt.fmt.pix.height;
+
+  v4l2_requestbuffers req;
+  memset(&req, 0, sizeof(req));
+  req.count = numCaptureBuffers;
+  req.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+  req.memory = V4L2_MEMORY_MMAP;
+
+  if (xioctl(_fd, VIDIOC_REQBUFS, &req) != 0) {
+    cerr << "***ERROR*** Camera does not support memory mapped streaming\n";
+    close();
+    return;
+  }
+
+  for (unsigned i = 0; i < req.count; i++) {
+    v4l2_buffer buf;
+    memset(&buf, 0, sizeof(buf));
+    buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    buf.memory = V4L2_MEMORY_MMAP;
+    buf.index = i;
+
+    if (xioctl(_fd, VIDIOC_QUERYBUF, &buf) != 0) {
+      close();
+      return;
+    }
+
+    Buffer b;
+    b.length = buf.length;
+    b.start = mmap(0, buf.length, PROT_READ | PROT_WRITE, MAP_SHARED, _fd, buf.m.offset);
+    if (b.start == MAP_FAILED) {
+      close();
+      return;
+    }
+    _buffers.push_back(b);
+
+    if (xioctl(_fd, VIDIOC_QBUF, &buf) != 0) {
+      close();
+      return;
+    }
+  }
+
+  v4l2_buf_type type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+  if (xioctl(_fd, VIDIOC_STREAMON, &type) != 0) {
+    cerr << "***ERROR*** Unable to start camera stream\n";
+    close();
+  }
+}
+
+V4l2Source::~V4l2Source() {
+  close();
+}
+
+void V4l2Source::close() {
+  if (_fd >= 0) {
+    v4l2_buf_type type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    xioctl(_fd, VIDIOC_STREAMOFF, &type);
+  }
+  for (size_t i = 0; i < _buffers.size(); i++) {
+    munmap(_buffers[i].start, _buffers[i].length);
+  }
+  _buffers.clear();
+  if (_fd >= 0) {
+    ::close(_fd);
+    _fd = -1;
+  }
+}
+
+bool V4l2Source::next(Image& img, int64_t& timeNanos) {
+  if (_fd < 0) {
+    return false;
+  }
+
+  v4l2_buffer buf;
+  memset(&buf, 0, sizeof(buf));
+  buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+  buf.memory = V4L2_MEMORY_MMAP;
+
+  // Blocks until the camera has a frame for us
+  if (xioctl(_fd, VIDIOC_DQBUF, &buf) != 0) {
+    return false;
+  }
+  timeNanos = nowNanos();
+
+  // Convert YUYV (2 pixels per 4 bytes) to RGB
+  img.resize(_width, _height);
+  const uint8_t* in = static_cast<const uint8_t*>(_buffers[buf.index].start);
+  uint8_t* out = &img.rgb[0];
+  int pairs = (_width * _height) / 2;
+
+  for (int i = 0; i < pairs; i++, in += 4) {
+    int u = in[1] - 128;
+    int v = in[3] - 128;
+    int rAdj = (359 * v) >> 8;
+    int gAdj = (88 * u + 183 * v) >> 8;
+    int bAdj = (454 * u) >> 8;
+
+    for (int j = 0; j < 2; j++) {
+      int y = in[j * 2];
+      *out++ = clampByte(y + rAdj);
+      *out++ = clampByte(y - gAdj);
+      *out++ = clampByte(y + bAdj);
+    }
+  }
+
+  return xioctl(_fd, VIDIOC_QBUF, &buf) == 0;
+}
@@ -0,0 +1,153 @@
+/**
+ * Definition of the Image class and the sources of camera frames used
+ * by avc-vision.
+ */
+#ifndef __avc_FrameSource_h
+#define __avc_FrameSource_h
+
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+
+namespace avc {
+
+  /**
+   * Simple packed 8 bit RGB image.
+   */
+  struct Image {
+    int width;
+    int height;
+    // width * height * 3 bytes (R, G, B order)
+    std::vector<uint8_t> rgb;
+
+    Image() : width(0), height(0), rgb() {
+    }
+
+    /** Resizes the image (contents are undefined). */
+    void resize(int w, int h) {
+      width = w;
+      height = h;
+      rgb.resize((size_t) w * h * 3);
+    }
+
+    /** Pointer to the first byte of a pixel. */
+    const uint8_t* pixel(int x, int y) const {
+      return &rgb[((size_t) y * width + x) * 3];
+    }
+
+    /**
+     * Loads a binary PPM (P6) file.
+     *
+     * @return true if loaded.
+     */
+    bool loadPpm(const std::string& path);
+
+    /**
+     * Saves as a binary PPM (P6) file.
+     *
+     * @return true if saved.
+     */
+    bool savePpm(const std::string& path) const;
+  };
+
+  /**
+   * Interface to something which produces camera frames.
+   */
+  class FrameSource {
+
+  public:
+    virtual ~FrameSource() {
+    }
+
+    /**
+     * Gets the next frame.
+     *
+     * @param img Where to store the frame (reused between calls to
+     * avoid allocations).
+     *
+     * @param timeNanos Set to the CLOCK_MONOTONIC time (in
+     * nanoseconds) the frame was captured.
+     *
+     * @return true if a frame was returned, false if there are no
+     * more frames (or the source failed).
+     */
+    virtual bool next(Image& img, int64_t& timeNanos) = 0;
+  };
+
+  /**
+   * Frame source which plays back the PPM images found in a directory
+   * (in name order) - used to measure performance and tune detection
+   * on a development machine.
+   */
+  class DirectorySource : public FrameSource {
+
+  public:
+    /**
+     * Constructs a new instance.
+     *
+     * @param dir The directory to find "*.ppm" files in.
+     *
+     * @param preload Load all images into memory up front (so disk
+     * I/O and decoding is not included in frame rates).
+     *
+     * @param loops How many times to play the images back.
+     */
+    DirectorySource(const std::string& dir, bool preload = true, int loops = 1);
+
+    /** Number of images found in the directory. */
+    int size() const { return (int) _files.size(); }
+
+    bool next(Image& img, int64_t& timeNanos);
+
+  private:
+    std::vector<std::string> _files;
+    std::vector<Image> _images;
+    int _loops;
+    size_t _idx;
+  };
+
+  /**
+   * Frame source which captures YUYV frames from a Video4Linux2
+   * camera (like the USB web cam on the robot) using memory mapped
+   * streaming I/O.
+   */
+  class V4l2Source : public FrameSource {
+
+  public:
+    /**
+     * Opens and starts streaming from the camera.
+     *
+     * @param device The camera device (like "/dev/video0").
+     * @param width Desired frame width.
+     * @param height Desired frame height.
+     */
+    V4l2Source(const std::string& device, int width = 320, int height = 240);
+
+    /** Stops streaming and closes the camera. */
+    ~V4l2Source();
+
+    /** Returns true if camera was opened and is streaming. */
+    bool isOpen() const { return _fd >= 0; }
+
+    bool next(Image& img, int64_t& timeNanos);
+
+  private:
+    V4l2Source(const V4l2Source&);
+
+    struct Buffer {
+      void* start;
+      size_t length;
+    };
+
+    void close();
+
+    int _fd;
+    int _width;
+    int _height;
+    std::vector<Buffer> _buffers;
+  };
+
+}
+
+#endif
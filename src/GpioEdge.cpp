@@ -0,0 +1,68 @@
+/**
+ * Implementation of the GpioEdge class.
+ */
+
+#include "GpioEdge.h"
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <unistd.h>
+
+using namespace avc;
+using namespace std;
+
+namespace {
+  string gpioPath(int gpio, const char* fileName) {
+    ostringstream path;
+    path << "/sys/class/gpio/gpio" << gpio << '/' << fileName;
+    return path.str();
+  }
+}
+
+// sysfs reports GPIO edges as "exceptional" conditions
+const uint32_t GpioEdge::EVENTS = EPOLLPRI | EPOLLERR;
+
+GpioEdge::GpioEdge(int gpio, const char* edge) :
+  _fd(-1),
+  _hasEdges(false),
+  _high(false)
+{
+  ofstream edgeFile(gpioPath(gpio, "edge").c_str());
+  _hasEdges = (edgeFile << edge << flush).good();
+  edgeFile.close();
+
+  string valuePath(gpioPath(gpio, "value"));
+  _fd = ::open(valuePath.c_str(), O_RDONLY | O_CLOEXEC);
+
+  if (_fd < 0) {
+    cerr << "***ERROR*** Unable to open " << valuePath << "\n";
+  } else if (!_hasEdges) {
+    cerr << "WARNING: Unable to enable edge detection on GPIO " << gpio << "\n";
+  }
+
+  // Initial read also clears any edge which is already pending
+  read();
+}
+
+GpioEdge::~GpioEdge() {
+  if (_fd >= 0) {
+    ::close(_fd);
+  }
+}
+
+bool GpioEdge::read() {
+  char c;
+  if ((_fd < 0) || (lseek(_fd, 0, SEEK_SET) != 0) || (::read(_fd, &c, 1) != 1)) {
+    return false;
+  }
+  _high = (c == '1');
+  return true;
+}
+
+void GpioEdge::onEvent(uint32_t events) {
+  read();
+}
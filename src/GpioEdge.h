@@ -0,0 +1,86 @@
+/**
+ * Definition of the GpioEdge event source.
+ */
+#ifndef __avc_GpioEdge_h
+#define __avc_GpioEdge_h
+
+#include "Reactor.h"
+
+namespace avc {
+
+  /**
+   * Watches a sysfs GPIO input for edges so a Reactor can wake up
+   * when a button changes state (instead of polling it).
+   *
+   * <p>The GPIO must already be exported and configured as an input
+   * (constructing a BlackLib::BlackGPIO does this). This class
+   * configures the "edge" file and keeps the "value" file open.</p>
+   *
+   * <pre>
+   * BlackLib::BlackGPIO button(BlackLib::GPIO_4, BlackLib::input);
+   * GpioEdge buttonEdge(BlackLib::GPIO_4);
+   * reactor.add(buttonEdge.getFd(), GpioEdge::EVENTS, buttonEdge);
+   * </pre>
+   */
+  class GpioEdge : public Reactor::Handler {
+
+  public:
+    /** The epoll events to watch for on a sysfs GPIO value file. */
+    static const uint32_t EVENTS;
+
+    /**
+     * Construct a new instance.
+     *
+     * @param gpio The kernel GPIO number (BlackLib::gpioName values
+     * match these numbers).
+     *
+     * @param edge Which edges to report: "rising", "falling" or
+     * "both" (the default).
+     */
+    GpioEdge(int gpio, const char* edge = "both");
+
+    /**
+     * Closes the value file.
+     */
+    ~GpioEdge();
+
+    /**
+     * Returns true if the value file is open.
+     */
+    bool isOpen() const { return _fd >= 0; }
+
+    /**
+     * Returns true if the kernel will report edges (if false, you
+     * will need to periodically call {@link #read} yourself).
+     */
+    bool hasEdges() const { return _hasEdges; }
+
+    /** File descriptor to add to a Reactor (watch for EVENTS). */
+    int getFd() const { return _fd; }
+
+    /**
+     * Returns the value read at the last edge (or last {@link #read}).
+     */
+    bool isHigh() const { return _high; }
+
+    /**
+     * Reads the current value of the GPIO.
+     *
+     * @return true if read successfully.
+     */
+    bool read();
+
+    /** Reads the new value after an edge. */
+    void onEvent(uint32_t events);
+
+  private:
+    GpioEdge(const GpioEdge&);
+
+    int _fd;
+    bool _hasEdges;
+    bool _high;
+  };
+
+}
+
+#endif
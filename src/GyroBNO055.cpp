@@ -5,8 +5,15 @@
 #include "GyroBNO055.h"
 #include "Timer.h"
 
+#include <cstdio>
 #include <iostream>
 
+#include <fcntl.h>
+#include <linux/i2c.h>
+#include <linux/i2c-dev.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
 using namespace avc;
 using namespace std;
 
@@ -38,7 +45,7 @@ namespace {
   // 9 DOF mode plus absolute angles
   const uint8_t ndofMode = 0x0C;
 
-  // The beginning of the accel data
+  // The beginning of the data block (accel data)
   const uint8_t accAddr = 0x08;
 
   // The 6 bytes containing the euler values (pitch, roll and heading) 
@@ -47,6 +54,35 @@ namespace {
   // The 2 heading registers (LSB, MSB)
   const uint8_t headingAddr = 0x1a;
 
+  // Offsets of each channel within the data block
+  const int accOffset = 0x08 - accAddr;
+  const int magOffset = 0x0e - accAddr;
+  const int gyroOffset = 0x14 - accAddr;
+  const int eulerOffset = 0x1a - accAddr;
+  const int quatOffset = 0x20 - accAddr;
+  const int linearAccOffset = 0x28 - accAddr;
+  const int gravityOffset = 0x2e - accAddr;
+  const int tempOffset = 0x34 - accAddr;
+  const int calibOffset = 0x35 - accAddr;
+
+  // Scale factors (LSB per unit) for default unit selection
+  const float accelLsb = 100.0;
+  const float magLsb = 16.0;
+  const float gyroLsb = 16.0;
+  const float eulerLsb = 16.0;
+  const float quatLsb = 16384.0;
+
+  // Signed 16 bit value stored LSB first
+  inline int16_t int16At(const uint8_t* raw, int offset) {
+    return (int16_t) ((raw[offset + 1] << 8) | raw[offset]);
+  }
+
+  inline void vectorAt(const uint8_t* raw, int offset, float lsb, GyroData::Vector& v) {
+    v.x = int16At(raw, offset) / lsb;
+    v.y = int16At(raw, offset + 2) / lsb;
+    v.z = int16At(raw, offset + 4) / lsb;
+  }
+
   bool setMode(BlackLib::BlackI2C& i2c, uint8_t mode) {
     if (!i2c.writeByte(operationModeAddr, mode)) {
       return false;
@@ -57,18 +93,55 @@ namespace {
 }
 
 
+//
+// GyroData methods
+//
+
+void GyroData::decode(const uint8_t* raw) {
+  vectorAt(raw, accOffset, accelLsb, accel);
+  vectorAt(raw, magOffset, magLsb, mag);
+  vectorAt(raw, gyroOffset, gyroLsb, gyro);
+
+  // Heading register is unsigned [0, 5760)
+  heading = ((raw[eulerOffset + 1] << 8) | raw[eulerOffset]) / eulerLsb;
+  roll = int16At(raw, eulerOffset + 2) / eulerLsb;
+  pitch = int16At(raw, eulerOffset + 4) / eulerLsb;
+
+  quatW = int16At(raw, quatOffset) / quatLsb;
+  quatX = int16At(raw, quatOffset + 2) / quatLsb;
+  quatY = int16At(raw, quatOffset + 4) / quatLsb;
+  quatZ = int16At(raw, quatOffset + 6) / quatLsb;
+
+  vectorAt(raw, linearAccOffset, accelLsb, linearAccel);
+  vectorAt(raw, gravityOffset, accelLsb, gravity);
+
+  temperature = (int8_t) raw[tempOffset];
+  calibration = raw[calibOffset];
+}
+
+//
+// GyroBNO055 methods
+//
+
 GyroBNO055::GyroBNO055(BlackLib::i2cName i2cDev, int i2cAddr) :
-  i2cGyro(i2cDev, i2cAddr)
+  i2cGyro(i2cDev, i2cAddr),
+  _i2cBus((int) i2cDev),
+  _i2cAddr(i2cAddr),
+  _burstFd(-1),
+  _data()
 {
 }
 
 GyroBNO055::~GyroBNO055() {
+  closeBurst();
   if (i2cGyro.isOpen()) {
     i2cGyro.close();
   }
 }
 
 bool GyroBNO055::reset() {
+  closeBurst();
+  _data.clear();
   if (i2cGyro.isOpen()) {
     i2cGyro.close();
   }
@@ -136,34 +209,67 @@ bool GyroBNO055::reset() {
   }
   Timer::sleepNanos(20000000);
 
+  if (!openBurst()) {
+    i2cGyro.close();
+    return false;
+  }
+
   return true;
 }
 
-/*
-bool GyroBNO055::update() {
-  if (i2cGyro.isOpen() == false) {
+bool GyroBNO055::openBurst() {
+  char dev[32];
+  snprintf(dev, sizeof(dev), "/dev/i2c-%d", _i2cBus);
+  _burstFd = ::open(dev, O_RDWR | O_CLOEXEC);
+  if (_burstFd < 0) {
+    cerr << "Failed to open " << dev << " for BNO055 burst reads\n";
     return false;
   }
+  return true;
+}
 
-  uint8_t rawBytes[dataLen];
-  int len = i2cGyro.readBlock(accelAddr, rawBytes, sizeof(rawBytes));
+void GyroBNO055::closeBurst() {
+  if (_burstFd >= 0) {
+    ::close(_burstFd);
+    _burstFd = -1;
+  }
+}
 
-  if (len != sizeof(rawBytes)) {
+bool GyroBNO055::update() {
+  if (_burstFd < 0) {
+    return false;
+  }
+
+  //
+  // BlackI2C::readBlock() goes through SMBus which limits a block to
+  // 32 bytes, so issue the register write and data read as one
+  // combined (repeated start) transaction ourselves
+  //
+  uint8_t reg = accAddr;
+  uint8_t rawBytes[DATA_LEN];
+
+  i2c_msg msgs[2];
+  msgs[0].addr = _i2cAddr;
+  msgs[0].flags = 0;
+  msgs[0].len = sizeof(reg);
+  msgs[0].buf = &reg;
+  msgs[1].addr = _i2cAddr;
+  msgs[1].flags = I2C_M_RD;
+  msgs[1].len = sizeof(rawBytes);
+  msgs[1].buf = rawBytes;
+
+  i2c_rdwr_ioctl_data xfer;
+  xfer.msgs = msgs;
+  xfer.nmsgs = 2;
+
+  if (ioctl(_burstFd, I2C_RDWR, &xfer) != 2) {
     cerr << "Failed to read in " << sizeof(rawBytes) << " bytes from BNO055\n";
-    i2cGyro.close();
     return false;
   }
-	
-  	for (int i = 0; i < len; i += 2) {
-		auto msb = rawBytes[i + 1];
-		auto lsb = rawBytes[i];
 
-		rawData[i / 2] = (uint16_t(msb) << 8) | lsb;
-	}
-	
-	return true;
+  _data.decode(rawBytes);
+  return true;
 }
-*/
 
 bool GyroBNO055::getHeading(float& angDeg) {
   if (i2cGyro.isOpen() == false) {
@@ -183,3 +289,18 @@ bool GyroBNO055::getHeading(float& angDeg) {
   return true;
 }
 
+std::ostream& GyroBNO055::dumpInfo(std::ostream& out) const {
+  const GyroData& d = _data;
+  out << "BNO055 heading: " << d.heading << " roll: " << d.roll
+      << " pitch: " << d.pitch
+      << "\n  accel: (" << d.accel.x << ", " << d.accel.y << ", " << d.accel.z << ")"
+      << "\n  linear accel: (" << d.linearAccel.x << ", " << d.linearAccel.y
+      << ", " << d.linearAccel.z << ")"
+      << "\n  gyro: (" << d.gyro.x << ", " << d.gyro.y << ", " << d.gyro.z << ")"
+      << "\n  mag: (" << d.mag.x << ", " << d.mag.y << ", " << d.mag.z << ")"
+      << "\n  quat: (" << d.quatW << ", " << d.quatX << ", " << d.quatY
+      << ", " << d.quatZ << ")"
+      << "\n  temp: " << d.temperature << " calibration: 0x" << std::hex
+      << (d.calibration & 0xff) << std::dec << "\n";
+  return out;
+}
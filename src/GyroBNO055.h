@@ -4,8 +4,14 @@
 #ifndef __avc_GyroBNO055_h
 #define __avc_GyroBNO055_h
 
+#include "GyroData.h"
+
 #include <BlackI2C.h>
 
+#include <ostream>
+
+#include <stdint.h>
+
 namespace avc {
 
   /**
@@ -85,10 +91,25 @@ namespace avc {
      */
     bool reset();
 
-	/**
-	 * Gets data from the gyroscope
-	 */
-	bool update();
+    /**
+     * Reads every data channel (accel, mag, gyro rate, euler angles,
+     * quaternion, linear accel, gravity, temperature and calibration
+     * status) in a single I2C burst transaction.
+     *
+     * <p>The sensor auto increments the register address, so one
+     * write of the starting register followed by a repeated start read
+     * returns the entire data block. The results are available from
+     * {@link #getData} afterwards.</p>
+     *
+     * @return true If all of the data was read, false if there was a
+     * problem (the previous values are left in place).
+     */
+    bool update();
+
+    /**
+     * Returns the values from the last successful {@link #update}.
+     */
+    const GyroData& getData() const { return _data; }
 
     /**
      * Get the current heading of the gyro (which way you are facing).
@@ -105,13 +126,27 @@ namespace avc {
      */
     std::ostream& dumpInfo(std::ostream& out) const;
 
+    // Number of bytes in the data register block (0x08 - 0x35)
+    static const int DATA_LEN = 0x2e;
+
   private:
-  // The total length of all of the gyro's data
-    const static uint8_t dataLen = 0x18;
+    // Opens the raw I2C device used for burst reads
+    bool openBurst();
+
+    // Closes the raw I2C device used for burst reads
+    void closeBurst();
 
     BlackLib::BlackI2C i2cGyro;
 
-	uint16_t rawData[dataLen / 2];
+    // I2C bus number (like 1 for /dev/i2c-1) and sensor address
+    int _i2cBus;
+    int _i2cAddr;
+
+    // Raw I2C device used for combined (write/read) burst transactions
+    int _burstFd;
+
+    // Values from last successful update
+    GyroData _data;
   };
 
 }
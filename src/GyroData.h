@@ -0,0 +1,81 @@
+/**
+ * Definition of the GyroData and GyroSample structures (the heading
+ * sensor readings shared by every hardware backend).
+ */
+#ifndef __avc_GyroData_h
+#define __avc_GyroData_h
+
+#include <cstring>
+
+#include <stdint.h>
+
+namespace avc {
+
+  /**
+   * All of the channels reported by the BNO055, decoded from a single
+   * burst read of the sensor data registers (see
+   * {@link GyroBNO055#update}). Units are the sensor defaults.
+   */
+  struct GyroData {
+    struct Vector {
+      float x;
+      float y;
+      float z;
+    };
+
+    // Acceleration (m/s^2) including gravity
+    Vector accel;
+    // Magnetic field (micro Tesla)
+    Vector mag;
+    // Angular rate (degrees/sec)
+    Vector gyro;
+    // Fused heading [0, 360), roll and pitch (degrees)
+    float heading;
+    float roll;
+    float pitch;
+    // Fused orientation quaternion
+    float quatW;
+    float quatX;
+    float quatY;
+    float quatZ;
+    // Acceleration (m/s^2) with gravity removed
+    Vector linearAccel;
+    // Gravity vector (m/s^2)
+    Vector gravity;
+    // Sensor temperature (degrees C)
+    int temperature;
+    // Calibration status (2 bits each: system, gyro, accel, mag)
+    uint8_t calibration;
+
+    GyroData() {
+      clear();
+    }
+
+    /** Sets all values to zero. */
+    void clear() { memset((char*) this, 0, sizeof(GyroData)); }
+
+    /**
+     * Decodes the raw register bytes read by a burst read (implemented
+     * with the GyroBNO055 register map).
+     */
+    void decode(const uint8_t* raw);
+  };
+
+  /**
+   * A single reading taken from the gyro by the GyroSampler.
+   */
+  struct GyroSample {
+    // CLOCK_MONOTONIC time (nanoseconds) the reading completed
+    int64_t timeNanos;
+    // Increments with each successful reading (0 until first reading)
+    uint32_t count;
+    // Every channel reported by the gyro (heading is [0, 360))
+    GyroData data;
+
+    GyroSample() : timeNanos(0), count(0), data() {
+    }
+  };
+
+}
+
+#endif
@@ -0,0 +1,131 @@
+/**
+ * Implementation of the GyroSampler class.
+ */
+
+#include "GyroSampler.h"
+#include "GyroBNO055.h"
+#include "PeriodicTimer.h"
+
+#include <iostream>
+#include <system_error>
+
+#include <time.h>
+
+using namespace avc;
+using namespace std;
+
+namespace {
+  // How many times to retry if we catch the writer mid update
+  const int maxAttempts = 1000;
+
+  int64_t nowNanos() {
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000000000LL + now.tv_nsec;
+  }
+}
+
+GyroSampler::GyroSampler(GyroBNO055& gyro, int rateHz) :
+  _gyro(gyro),
+  _periodNanos(1000000000LL / ((rateHz > 0) ? rateHz : 1)),
+  _thread(),
+  _running(false),
+  _seq(0),
+  _sample(),
+  _failures(0),
+  _maxReadNanos(0)
+{
+}
+
+GyroSampler::~GyroSampler() {
+  stop();
+}
+
+bool GyroSampler::start() {
+  if (_thread.joinable()) {
+    return true;
+  }
+
+  __atomic_store_n(&_running, true, __ATOMIC_RELEASE);
+  try {
+    _thread = thread(&GyroSampler::run, this);
+  } catch (const system_error& e) {
+    __atomic_store_n(&_running, false, __ATOMIC_RELEASE);
+    cerr << "***ERROR*** Unable to start gyro sampler thread: " << e.what() << "\n";
+    return false;
+  }
+  return true;
+}
+
+void GyroSampler::stop() {
+  __atomic_store_n(&_running, false, __ATOMIC_RELEASE);
+  if (_thread.joinable()) {
+    _thread.join();
+  }
+}
+
+bool GyroSampler::isRunning() const {
+  return __atomic_load_n(&_running, __ATOMIC_ACQUIRE) && _thread.joinable();
+}
+
+bool GyroSampler::getLatest(GyroSample& sample, int64_t maxAgeNanos) const {
+  for (int i = 0; i < maxAttempts; i++) {
+    uint32_t seq = __atomic_load_n(&_seq, __ATOMIC_ACQUIRE);
+    if (seq & 1) {
+      continue;
+    }
+    GyroSample copy = _sample;
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    if (__atomic_load_n(&_seq, __ATOMIC_RELAXED) == seq) {
+      if ((copy.count == 0) || ((nowNanos() - copy.timeNanos) > maxAgeNanos)) {
+        return false;
+      }
+      sample = copy;
+      return true;
+    }
+  }
+  return false;
+}
+
+uint32_t GyroSampler::getFailures() const {
+  return __atomic_load_n(&_failures, __ATOMIC_RELAXED);
+}
+
+int64_t GyroSampler::getMaxReadNanos() const {
+  return __atomic_load_n(&_maxReadNanos, __ATOMIC_RELAXED);
+}
+
+void GyroSampler::publish(const GyroSample& sample) {
+  uint32_t seq = _seq;
+  __atomic_store_n(&_seq, seq + 1, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+  _sample = sample;
+  __atomic_store_n(&_seq, seq + 2, __ATOMIC_RELEASE);
+}
+
+void GyroSampler::run() {
+  PeriodicTimer timer(_periodNanos);
+  GyroSample sample;
+  timer.start();
+
+  while (__atomic_load_n(&_running, __ATOMIC_ACQUIRE)) {
+    int64_t readStart = nowNanos();
+    bool ok = _gyro.update();
+    int64_t readEnd = nowNanos();
+
+    if ((readEnd - readStart) > _maxReadNanos) {
+      __atomic_store_n(&_maxReadNanos, readEnd - readStart, __ATOMIC_RELAXED);
+    }
+
+    if (ok) {
+      sample.timeNanos = readEnd;
+      sample.data = _gyro.getData();
+      sample.count++;
+      publish(sample);
+    } else {
+      __atomic_store_n(&_failures, _failures + 1, __ATOMIC_RELAXED);
+    }
+
+    timer.waitForNext();
+  }
+}
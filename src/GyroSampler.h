@@ -0,0 +1,127 @@
+/**
+ * Definition of the GyroSampler class.
+ */
+#ifndef __avc_GyroSampler_h
+#define __avc_GyroSampler_h
+
+#include "GyroData.h"
+
+#include <thread>
+
+#include <stdint.h>
+
+namespace avc {
+
+  class GyroBNO055;
+
+  /**
+   * Reads all of the gyro channels (one burst read per sample, see
+   * {@link GyroBNO055#update}) on a background thread at a fixed rate and
+   * publishes the newest sample so the control loop never has to wait
+   * on the I2C bus.
+   *
+   * <p>There is a single writer (the sampler thread) which publishes
+   * with a sequence lock: the sequence number is odd while a sample is
+   * being written and even once it is complete. Readers copy the
+   * sample and retry if the sequence changed (or was odd), so neither
+   * side ever blocks on the other.</p>
+   *
+   * <p>Once started, the sampler thread owns the gyro. Do not call
+   * methods on the GyroBNO055 directly until {@link #stop} is
+   * invoked.</p>
+   *
+   * <pre><code>
+   * GyroBNO055 gyro;
+   * gyro.reset();
+   *
+   * GyroSampler sampler(gyro);
+   * sampler.start();
+   *
+   * GyroSample sample;
+   * if (sampler.getLatest(sample)) {
+   *   cout << "Heading: " << sample.data.heading << "\n";
+   * }
+   * </code></pre>
+   */
+  class GyroSampler {
+
+  public:
+    // BNO055 fusion output rate in NDOF mode
+    static const int DEFAULT_RATE_HZ = 100;
+
+    // Samples older than this are considered stale (10 periods)
+    static const int64_t DEFAULT_MAX_AGE_NANOS = 100000000;
+
+    /**
+     * Constructs a new instance (call {@link #start} to begin sampling).
+     *
+     * @param gyro The gyro to read (must already be reset).
+     * @param rateHz How many times per second to read the gyro.
+     */
+    GyroSampler(GyroBNO055& gyro, int rateHz = DEFAULT_RATE_HZ);
+
+    /** Stops the sampler thread (if running). */
+    ~GyroSampler();
+
+    /**
+     * Starts the sampler thread (does nothing if already running).
+     *
+     * @return true if sampler thread is running.
+     */
+    bool start();
+
+    /**
+     * Stops the sampler thread and waits for it to exit.
+     */
+    void stop();
+
+    /** Returns true if the sampler thread is running. */
+    bool isRunning() const;
+
+    /**
+     * Gets the newest sample without waiting on the gyro.
+     *
+     * @param sample Where to store the sample.
+     *
+     * @param maxAgeNanos How old the sample is allowed to be.
+     *
+     * @return true if a sample no older than maxAgeNanos was
+     * available, false if there has been no reading yet or the gyro
+     * has stopped responding.
+     */
+    bool getLatest(GyroSample& sample,
+                   int64_t maxAgeNanos = DEFAULT_MAX_AGE_NANOS) const;
+
+    /** Number of times reading the gyro failed. */
+    uint32_t getFailures() const;
+
+    /** Longest time (nanoseconds) a single read of the gyro took. */
+    int64_t getMaxReadNanos() const;
+
+  private:
+    GyroSampler(const GyroSampler&);
+    GyroSampler& operator=(const GyroSampler&);
+
+    // Entry point of the sampler thread
+    void run();
+
+    // Publishes a new sample (only called by sampler thread)
+    void publish(const GyroSample& sample);
+
+    GyroBNO055& _gyro;
+    int64_t _periodNanos;
+    std::thread _thread;
+    bool _running;
+
+    // Sequence lock and sample it protects
+    uint32_t _seq;
+    GyroSample _sample;
+
+    // Statistics (written by sampler thread only)
+    uint32_t _failures;
+    int64_t _maxReadNanos;
+  };
+
+}
+
+#endif
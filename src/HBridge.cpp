@@ -4,11 +4,58 @@
 
 #include "HBridge.h"
 
+#include <sstream>
+
+#include <glob.h>
+
 using namespace avc;
+using namespace std;
 
 namespace {
   const float minPower = -1.0;
   const float maxPower = +1.0;
+
+  const char* pwmPinName(BlackLib::pwmName pwm) {
+    switch (pwm) {
+    case BlackLib::P8_13: return "P8_13";
+    case BlackLib::P8_19: return "P8_19";
+    case BlackLib::P9_14: return "P9_14";
+    case BlackLib::P9_16: return "P9_16";
+    case BlackLib::P9_21: return "P9_21";
+    case BlackLib::P9_22: return "P9_22";
+    case BlackLib::P9_42: return "P9_42";
+    }
+    return "";
+  }
+
+  // The duty file of the pwm_test device BlackLib set up for the pin
+  string pwmDutyPath(BlackLib::pwmName pwm) {
+    string pattern("/sys/devices/ocp.*/pwm_test_");
+    pattern += pwmPinName(pwm);
+    pattern += ".*/duty";
+
+    string path;
+    glob_t found;
+    if ((glob(pattern.c_str(), 0, 0, &found) == 0) && (found.gl_pathc > 0)) {
+      path = found.gl_pathv[0];
+    }
+    globfree(&found);
+    return path;
+  }
+
+  string gpioValuePath(BlackLib::gpioName gpio) {
+    // BlackLib::gpioName values match the kernel GPIO numbers
+    ostringstream path;
+    path << "/sys/class/gpio/gpio" << (int) gpio << "/value";
+    return path.str();
+  }
+
+  void openFile(SysfsFile& file, const string& path) {
+    if (path.empty() || !file.open(path)) {
+      cerr << "WARNING: Unable to keep " << (path.empty() ? "PWM duty file" : path)
+	   << " open (falling back to BlackLib)\n";
+    }
+  }
 }
 
 
@@ -19,8 +66,26 @@ HBridge::HBridge(BlackLib::pwmName power, BlackLib::gpioName fwd,
   gpioRev(new BlackLib::BlackGPIO(rev, BlackLib::output, BlackLib::FastMode)),
   period(periodNanos),
   curVal(0),
-  enabled(false)
+  enabled(false),
+  fwdState(false),
+  revState(false),
+  fwdFile(),
+  revFile(),
+  dutyFile(),
+  dutyStrings(DUTY_STEPS + 1),
+  dutyStep(-1)
 {
+  for (int i = 0; i <= DUTY_STEPS; i++) {
+    ostringstream duty;
+    duty << ((period * i) / DUTY_STEPS);
+    dutyStrings[i] = duty.str();
+  }
+
+  openFile(fwdFile, gpioValuePath(fwd));
+  openFile(revFile, gpioValuePath(rev));
+  // BlackLib creates the pwm_test device when pwmPower is constructed
+  openFile(dutyFile, pwmDutyPath(power));
+
   disable();
 }
 
@@ -41,28 +106,13 @@ bool HBridge::set(float newVal) {
 
   bool fwd = (newVal > 0);
   bool rev = (newVal < 0);
-  // BlackLib duty percent is opposite of how I think about it
-  float duty = 100.0 * (1 - (rev ? -newVal : newVal));
-
-  if (fwd != fwdState) {
-    if (gpioFwd->setValue(fwd ? BlackLib::high : BlackLib::low)) {
-      fwdState = fwd;
-    } else {
-      disable();
-      return false;
-    }
-  }
-
-  if (rev != revState) {
-    if (gpioRev->setValue(rev ? BlackLib::high : BlackLib::low)) {
-      revState = rev;
-    } else {
-      disable();
-      return false;
-    }
+  if (!setGears(fwd, rev)) {
+    disable();
+    return false;
   }
 
-  bool ok = (enabled ? pwmPower.setDutyPercent(duty) : enable(duty));
+  float power = (rev ? -newVal : newVal);
+  bool ok = (enabled ? setDuty(power) : enable(power));
   if (ok == true) {
     curVal = newVal;
   } else {
@@ -83,38 +133,68 @@ bool HBridge::seek(float newVal, float maxStep) {
 }
 
 void HBridge::brake() {
-  gpioFwd->setValue(BlackLib::high);
-  gpioRev->setValue(BlackLib::high);
+  setGears(true, true);
 }
 
 void HBridge::releaseBrake() {
-  gpioFwd->setValue(BlackLib::low);
-  gpioRev->setValue(BlackLib::low);
+  setGears(false, false);
 }
 
 void HBridge::disable() {
   enabled = false;
   curVal = 0.0;
-  fwdState = false;
-  revState = false;
-  gpioFwd->setValue(fwdState ? BlackLib::high : BlackLib::low);
-  gpioRev->setValue(revState ? BlackLib::high : BlackLib::low);
-  pwmPower.setDutyPercent(100.0);
+  setGears(false, false, true);
+  setDuty(0, true);
 
   pwmPower.setRunState(BlackLib::stop);
 }
 
-bool HBridge::enable(float dutyPercent) {
+bool HBridge::enable(float power) {
   if (enabled == false) {
+    // BlackLib duty percent is opposite of how I think about it
     enabled = pwmPower.setDutyPercent(100.0) &&
       pwmPower.setPeriodTime(period) &&
       pwmPower.setPolarity(BlackLib::straight) &&
-      pwmPower.setDutyPercent(dutyPercent) &&
+      setDuty(power, true) &&
       pwmPower.setRunState(BlackLib::run);
   }
   return enabled;
 }
 
+bool HBridge::setGears(bool fwd, bool rev, bool force) {
+  bool ok = true;
+
+  if (force || (fwd != fwdState)) {
+    ok = (fwdFile.isOpen() ? fwdFile.write(fwd ? "1" : "0", 1) :
+	  gpioFwd->setValue(fwd ? BlackLib::high : BlackLib::low));
+    fwdState = fwd;
+  }
+
+  if (force || (rev != revState)) {
+    ok = (revFile.isOpen() ? revFile.write(rev ? "1" : "0", 1) :
+	  gpioRev->setValue(rev ? BlackLib::high : BlackLib::low)) && ok;
+    revState = rev;
+  }
+
+  return ok;
+}
+
+bool HBridge::setDuty(float power, bool force) {
+  int step = (int) (power * DUTY_STEPS + 0.5);
+  step = (step < 0) ? 0 : ((step > DUTY_STEPS) ? DUTY_STEPS : step);
+
+  if (!force && (step == dutyStep)) {
+    return true;
+  }
+
+  const string& duty = dutyStrings[step];
+  bool ok = (dutyFile.isOpen() ? dutyFile.write(duty.c_str(), duty.size()) :
+	     pwmPower.setDutyPercent(100.0 * (DUTY_STEPS - step) / DUTY_STEPS));
+  // Force a write next time if this one failed
+  dutyStep = (ok ? step : -1);
+  return ok;
+}
+
 std::ostream& HBridge::dumpInfo(std::ostream& out) const {
   out << "       Cycle (Hz): " << (1.0e9 / period)
       << "\n    Period (nanos): " << period
@@ -122,6 +202,16 @@ std::ostream& HBridge::dumpInfo(std::ostream& out) const {
       << "\n      Forward Gear: " << (fwdState ? "true" : "false")
       << "\n      Reverse Gear: " << (revState ? "true" : "false")
       << "\n";
+  return printWriteStats(out);
+}
+
+std::ostream& HBridge::printWriteStats(std::ostream& out) const {
+  const SysfsFile* files[] = { &fwdFile, &revFile, &dutyFile };
+  for (int i = 0; i < 3; i++) {
+    if (files[i]->isOpen()) {
+      files[i]->printStats(out << "  ") << "\n";
+    }
+  }
   return out;
 }
 
@@ -4,9 +4,14 @@
 #ifndef __avc_HBridge_h
 #define __avc_HBridge_h
 
+#include "SysfsFile.h"
+
 #include <BlackGPIO.h>
 #include <BlackPWM.h>
 
+#include <string>
+#include <vector>
+
 namespace avc {
 
   /**
@@ -14,6 +19,12 @@ namespace avc {
    * used to control power output to motors via a PWM signal and two
    * control lines with four states (forward, reverse, coast and
    * brake).
+   *
+   * <p>BlackLib is used to export and configure the pins, after that
+   * the GPIO "value" and PWM "duty" files are kept open and only
+   * written to when the value actually changes. Duty cycles are
+   * quantized to DUTY_STEPS steps with the nanosecond strings
+   * formatted up front, so setting the power never formats text.</p>
    */
   class HBridge {
 
@@ -34,6 +45,9 @@ namespace avc {
     HBridge(BlackLib::pwmName pwmPower, BlackLib::gpioName gpioFwd,
 	    BlackLib::gpioName gpioRev, uint64_t period = 1000000);
 
+    // Resolution of the duty cycle (number of steps from 0 to full power)
+    static const int DUTY_STEPS = 1000;
+
     /**
      * Destructor will disable power and shift it into neutral (coast).
      */
@@ -99,6 +113,12 @@ namespace avc {
      */
     std::ostream& dumpInfo(std::ostream& out) const;
 
+    /**
+     * Prints how many writes were made to the GPIO and PWM files and
+     * how long they took.
+     */
+    std::ostream& printWriteStats(std::ostream& out) const;
+
   private:
     BlackLib::BlackPWM pwmPower;
 
@@ -113,16 +133,49 @@ namespace avc {
     bool fwdState;
     bool revState;
 
+    // Open GPIO value files and PWM duty file (BlackLib used if not open)
+    SysfsFile fwdFile;
+    SysfsFile revFile;
+    SysfsFile dutyFile;
+
+    // Duty (nanoseconds) for each step from 0 to DUTY_STEPS
+    std::vector<std::string> dutyStrings;
+
+    // Duty step last written (-1 if unknown)
+    int dutyStep;
+
+    /**
+     * Shifts gears (only writing GPIO values that changed).
+     *
+     * @param fwd State of the forward control line.
+     * @param rev State of the reverse control line.
+     * @param force Write both values even if they have not changed.
+     *
+     * @return true if successful.
+     */
+    bool setGears(bool fwd, bool rev, bool force = false);
+
+    /**
+     * Writes the duty cycle (if different than what was last written).
+     *
+     * @param power Power level in the range of [0, 1.0].
+     * @param force Write even if the step has not changed.
+     *
+     * @return true if successful.
+     */
+    bool setDuty(float power, bool force = false);
+
     /**
      * Enables the motor to be operated (you do not need to call this
      * directly, as set() calls when you try to set a value).
      *
-     * @param dutyPercent Initial duty percent to set if enabling is required.
+     * @param power Initial power level [0, 1.0] to set if enabling
+     * is required.
      *
      * @return false if the motor needed to be initialized and there
      * was a problem.
      */
-    bool enable(float dutyPercent);
+    bool enable(float power);
   };
 
 }
@@ -0,0 +1,60 @@
+/**
+ * Selects the hardware abstraction layer (HAL) backend the control
+ * code is compiled against.
+ */
+#ifndef __avc_Hal_h
+#define __avc_Hal_h
+
+// Set to 1 (make HAL=memory) to build against in-memory devices
+// instead of the BlackLib hardware on the BBB
+#ifndef AVC_HAL_MEMORY
+#define AVC_HAL_MEMORY 0
+#endif
+
+#include "HalTypes.h"
+
+#if AVC_HAL_MEMORY
+#include "HalMemory.h"
+#else
+#include "HalBlackLib.h"
+#endif
+
+namespace avc {
+
+  /**
+   * The HAL backend policy the vehicle is built with.
+   *
+   * <p>A backend is a struct of types (no virtual methods, the
+   * compiler sees the concrete device classes so the calls made
+   * every tick can be inlined). Each backend must provide:</p>
+   *
+   * <ul>
+   * <li>Motor - constructed from a MotorSide with get(), set(power),
+   * seek(power, maxStep), brake(), releaseBrake(), disable() and
+   * printWriteStats(out).</li>
+   *
+   * <li>HeadingSensor - start(), isRunning(), getLatest(GyroSample&),
+   * getFailures() and getMaxReadNanos() (same as GyroSampler).</li>
+   *
+   * <li>VisionSource - open(path), isOpen(), skipToLatest(),
+   * drain(frames, maxFrames) and getLostFrames() (same as
+   * VisionReader).</li>
+   *
+   * <li>Leds - a singleton (getInstance()) with the Pattern enum,
+   * setState(bits) and setPattern(pattern, periodMillis) (same as
+   * UserLeds).</li>
+   *
+   * <li>Button - a Reactor::Handler constructed from a ButtonId with
+   * EVENTS, getFd(), hasEdges(), isHigh() and read() (same as
+   * GpioEdge).</li>
+   * </ul>
+   */
+#if AVC_HAL_MEMORY
+  typedef MemoryHal Hal;
+#else
+  typedef BlackLibHal Hal;
+#endif
+
+}
+
+#endif
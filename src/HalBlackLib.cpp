@@ -0,0 +1,85 @@
+/**
+ * Implementation of the BlackLib HAL backend.
+ */
+
+#include "HalBlackLib.h"
+
+using namespace avc;
+using namespace std;
+
+namespace {
+  //
+  // The "map" of GPIO pins (how things need to be wired)
+  //
+
+  // P9 pin 16 (GPIO 51)
+  const BlackLib::pwmName RIGHT_PWM = BlackLib::P9_16;
+  // P9 pin 17 (GPIO 5)
+  const BlackLib::gpioName RIGHT_GPIO_FWD = BlackLib::GPIO_5;
+  // P9 pin 23 (GPIO 49)
+  const BlackLib::gpioName RIGHT_GPIO_REV = BlackLib::GPIO_49;
+
+  // P9 pin 21 (GPIO 3)
+  const BlackLib::pwmName LEFT_PWM = BlackLib::P9_21;
+  // P9 pin 15 (GPIO 48)
+  const BlackLib::gpioName LEFT_GPIO_FWD = BlackLib::GPIO_48;
+  // P9 pin 12 (GPIO 60)
+  const BlackLib::gpioName LEFT_GPIO_REV = BlackLib::GPIO_60;
+
+  // Long path start button P9 pin 18 (GPIO 4)
+  const BlackLib::gpioName LONG_BUTTON_GPIO = BlackLib::GPIO_4;
+  // Short path start button P9 pin 24 (GPIO 15)
+  const BlackLib::gpioName SHORT_BUTTON_GPIO = BlackLib::GPIO_15;
+
+  inline BlackLib::gpioName buttonGpio(ButtonId id) {
+    return (id == LONG_BUTTON) ? LONG_BUTTON_GPIO : SHORT_BUTTON_GPIO;
+  }
+}
+
+//
+// BlackLibMotor methods
+//
+
+BlackLibMotor::BlackLibMotor(MotorSide side) :
+#if USE_SERVOS
+  Servo((side == LEFT_MOTOR) ? LEFT_PWM : RIGHT_PWM, -1.0, +1.0)
+#else
+  HBridge((side == LEFT_MOTOR) ? LEFT_PWM : RIGHT_PWM,
+          (side == LEFT_MOTOR) ? LEFT_GPIO_FWD : RIGHT_GPIO_FWD,
+          (side == LEFT_MOTOR) ? LEFT_GPIO_REV : RIGHT_GPIO_REV)
+#endif
+{
+}
+
+//
+// BlackLibHeading methods
+//
+
+BlackLibHeading::BlackLibHeading() :
+  _gyro(),
+  _sampler(_gyro)
+{
+}
+
+bool BlackLibHeading::start() {
+  if (_sampler.isRunning()) {
+    return true;
+  }
+  if (!_gyro.reset()) {
+    cerr << "**ERROR*** Failed to reset gyro\n";
+    return false;
+  }
+  return _sampler.start();
+}
+
+//
+// BlackLibButton methods
+//
+
+const uint32_t BlackLibButton::EVENTS = GpioEdge::EVENTS;
+
+BlackLibButton::BlackLibButton(ButtonId id) :
+  _gpio(buttonGpio(id), BlackLib::input),
+  _edge(buttonGpio(id))
+{
+}
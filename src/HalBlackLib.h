@@ -0,0 +1,141 @@
+/**
+ * Definition of the BlackLib HAL backend (the real hardware on the BBB).
+ */
+#ifndef __avc_HalBlackLib_h
+#define __avc_HalBlackLib_h
+
+#define USE_SERVOS 0
+
+#include "GpioEdge.h"
+#include "GyroBNO055.h"
+#include "GyroSampler.h"
+#include "HalTypes.h"
+#include "UserLeds.h"
+#include "VisionReader.h"
+#if USE_SERVOS
+#include "Servo.h"
+#else
+#include "HBridge.h"
+#endif
+
+#include <BlackGPIO.h>
+
+#include <iostream>
+
+namespace avc {
+
+  /**
+   * Motor driving one side of the car (an HBridge or ESC wired to
+   * the pins assigned to that side).
+   */
+#if USE_SERVOS
+  class BlackLibMotor : public Servo {
+#else
+  class BlackLibMotor : public HBridge {
+#endif
+
+  public:
+    /**
+     * Construct a new instance.
+     *
+     * @param side Which side of the car the motor drives.
+     */
+    BlackLibMotor(MotorSide side);
+
+#if USE_SERVOS
+    /** Servos do not keep write statistics. */
+    std::ostream& printWriteStats(std::ostream& out) const { return out; }
+#endif
+  };
+
+  /**
+   * The BNO055 gyro read on a background thread by a GyroSampler.
+   */
+  class BlackLibHeading {
+
+  public:
+    BlackLibHeading();
+
+    /**
+     * Resets the gyro and starts the sampler thread.
+     *
+     * @return true if gyro was found and is being sampled.
+     */
+    bool start();
+
+    /** Returns true if the sampler thread is running. */
+    bool isRunning() const { return _sampler.isRunning(); }
+
+    /** Gets the newest sample (see GyroSampler::getLatest). */
+    bool getLatest(GyroSample& sample,
+                   int64_t maxAgeNanos = GyroSampler::DEFAULT_MAX_AGE_NANOS) const {
+      return _sampler.getLatest(sample, maxAgeNanos);
+    }
+
+    /** Number of times reading the gyro failed. */
+    uint32_t getFailures() const { return _sampler.getFailures(); }
+
+    /** Longest time (nanoseconds) a single read of the gyro took. */
+    int64_t getMaxReadNanos() const { return _sampler.getMaxReadNanos(); }
+
+  private:
+    BlackLibHeading(const BlackLibHeading&);
+
+    GyroBNO055 _gyro;
+    // Owns _gyro once started
+    GyroSampler _sampler;
+  };
+
+  /**
+   * A start button wired to a GPIO input (kernel reports edges).
+   */
+  class BlackLibButton : public Reactor::Handler {
+
+  public:
+    /** The epoll events to watch for. */
+    static const uint32_t EVENTS;
+
+    /**
+     * Construct a new instance (exports the GPIO as an input).
+     *
+     * @param id Which button.
+     */
+    BlackLibButton(ButtonId id);
+
+    /** File descriptor to add to a Reactor (watch for EVENTS). */
+    int getFd() const { return _edge.getFd(); }
+
+    /** Returns true if the kernel will report edges. */
+    bool hasEdges() const { return _edge.hasEdges(); }
+
+    /** Returns the value read at the last edge (or last {@link #read}). */
+    bool isHigh() const { return _edge.isHigh(); }
+
+    /** Reads the current value of the button. */
+    bool read() { return _edge.read(); }
+
+    /** Reads the new value after an edge. */
+    void onEvent(uint32_t events) { _edge.onEvent(events); }
+
+  private:
+    BlackLibButton(const BlackLibButton&);
+
+    // Must be constructed first (exports the GPIO)
+    BlackLib::BlackGPIO _gpio;
+    GpioEdge _edge;
+  };
+
+  /**
+   * HAL backend for the real hardware (see Hal.h).
+   */
+  struct BlackLibHal {
+    typedef BlackLibMotor Motor;
+    typedef BlackLibHeading HeadingSensor;
+    typedef VisionReader VisionSource;
+    typedef UserLeds Leds;
+    typedef BlackLibButton Button;
+  };
+
+}
+
+#endif
@@ -0,0 +1,179 @@
+/**
+ * Implementation of the in-memory HAL backend.
+ */
+
+#include "HalMemory.h"
+#include "Clock.h"
+
+#include <cmath>
+
+using namespace avc;
+using namespace std;
+
+//
+// MemoryMotor methods
+//
+
+MemoryMotor::MemoryMotor(MotorSide side) :
+  _side(side),
+  _power(0),
+  _braking(false),
+  _enabled(false),
+  _changes(0)
+{
+}
+
+bool MemoryMotor::set(float val) {
+  if ((val < -1.0) || (val > 1.0)) {
+    // Out of range, ignore request
+    return false;
+  }
+  if ((val != _power) || _braking || !_enabled) {
+    _changes++;
+  }
+  _power = val;
+  _braking = false;
+  _enabled = true;
+  return true;
+}
+
+bool MemoryMotor::seek(float val, float maxStep) {
+  float desiredStep = val - _power;
+  if (desiredStep < -maxStep) {
+    val = _power - maxStep;
+  } else if (desiredStep > maxStep) {
+    val = _power + maxStep;
+  }
+  return set(val);
+}
+
+void MemoryMotor::disable() {
+  _power = 0;
+  _braking = false;
+  _enabled = false;
+}
+
+ostream& MemoryMotor::printWriteStats(ostream& out) const {
+  return out << "  " << ((_side == LEFT_MOTOR) ? "left" : "right")
+             << " (memory): " << _changes << " changes\n";
+}
+
+//
+// MemoryHeading methods
+//
+
+MemoryHeading::MemoryHeading() :
+  _data(),
+  _count(0),
+  _running(false),
+  _responding(true),
+  _failures(0)
+{
+}
+
+void MemoryHeading::setData(const GyroData& data) {
+  _data = data;
+  _data.heading = fmod(_data.heading, 360.0f);
+  if (_data.heading < 0) {
+    _data.heading += 360.0f;
+  }
+  _count++;
+}
+
+void MemoryHeading::setHeading(float heading) {
+  GyroData data(_data);
+  data.heading = heading;
+  setData(data);
+}
+
+bool MemoryHeading::getLatest(GyroSample& sample, int64_t maxAgeNanos) const {
+  if (!_running || !_responding) {
+    _failures++;
+    return false;
+  }
+  sample.timeNanos = Clock::nowNanos();
+  sample.count = _count;
+  sample.data = _data;
+  return true;
+}
+
+//
+// MemoryVision methods
+//
+
+MemoryVision::MemoryVision() :
+  _open(false),
+  _frameCount(0),
+  _head(0),
+  _tail(0),
+  _lost(0)
+{
+}
+
+void MemoryVision::publish(const FileData& data, int64_t timeNanos) {
+  VisionFrame frame;
+  frame.timeNanos = timeNanos;
+  frame.data = data;
+  frame.data.frameCount = frame.data.safetyFrameCount = ++_frameCount;
+  publish(frame);
+}
+
+void MemoryVision::publish(const VisionFrame& frame) {
+  _frames[_head % VisionRing::CAPACITY] = frame;
+  _head++;
+}
+
+int MemoryVision::drain(VisionFrame* frames, int maxFrames) {
+  if (!_open) {
+    return -1;
+  }
+  if (_head - _tail > VisionRing::CAPACITY) {
+    // Oldest frames were already overwritten
+    _lost += _head - _tail - VisionRing::CAPACITY;
+    _tail = _head - VisionRing::CAPACITY;
+  }
+
+  int n = 0;
+  while ((_tail != _head) && (n < maxFrames)) {
+    frames[n++] = _frames[_tail++ % VisionRing::CAPACITY];
+  }
+  return n;
+}
+
+void MemoryVision::skipToLatest() {
+  if (_head > 0) {
+    _tail = _head - 1;
+  }
+}
+
+//
+// MemoryLeds methods
+//
+
+MemoryLeds MemoryLeds::instance;
+
+MemoryLeds::MemoryLeds() :
+  _state(0),
+  _pattern(NONE)
+{
+}
+
+bool MemoryLeds::setLed(int led, bool turnOn) {
+  if ((led < 0) || (led > 3)) {
+    return false;
+  }
+  int mask = 1 << led;
+  int state = getState();
+  return setState(turnOn ? (state | mask) : (state & ~mask));
+}
+
+//
+// MemoryButton methods
+//
+
+MemoryButton::MemoryButton(ButtonId id) :
+  _id(id),
+  _value(false),
+  _high(false)
+{
+}
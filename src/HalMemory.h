@@ -0,0 +1,305 @@
+/**
+ * Definition of the in-memory HAL backend (lets the control code
+ * build and run on a PC).
+ */
+#ifndef __avc_HalMemory_h
+#define __avc_HalMemory_h
+
+#include "FileData.h"
+#include "GyroData.h"
+#include "HalTypes.h"
+#include "Reactor.h"
+
+#include <iostream>
+#include <string>
+
+#include <stdint.h>
+
+namespace avc {
+
+  /**
+   * A motor which just remembers the power level and brake state it
+   * was last given.
+   */
+  class MemoryMotor {
+
+  public:
+    /**
+     * Construct a new instance.
+     *
+     * @param side Which side of the car the motor drives.
+     */
+    MemoryMotor(MotorSide side);
+
+    /** Which side of the car the motor drives. */
+    MotorSide getSide() const { return _side; }
+
+    /** Gets the current power level (last value set). */
+    float get() const { return _power; }
+
+    /**
+     * Sets the power output value (releases the brake like shifting
+     * the HBridge does).
+     *
+     * @param val The new power value in the range of [-1.0, +1.0].
+     *
+     * @return true if value accepted, false if out of range.
+     */
+    bool set(float val);
+
+    /**
+     * Seeks the target value, but limits the maximum power adjustment.
+     */
+    bool seek(float val, float maxStep);
+
+    /** Brakes the motor. */
+    void brake() { _braking = true; }
+
+    /** Releases the brake. */
+    void releaseBrake() { _braking = false; }
+
+    /** Returns true if the brake is on. */
+    bool isBraking() const { return _braking; }
+
+    /** Returns true if motor is being controlled. */
+    bool isEnabled() const { return _enabled; }
+
+    /** Sets power to 0, releases the brake and stops controlling the motor. */
+    void disable();
+
+    /** Prints how many times the power level was changed. */
+    std::ostream& printWriteStats(std::ostream& out) const;
+
+  private:
+    MotorSide _side;
+    float _power;
+    bool _braking;
+    bool _enabled;
+    uint32_t _changes;
+  };
+
+  /**
+   * A heading sensor which reports whatever heading it was last given.
+   */
+  class MemoryHeading {
+
+  public:
+    MemoryHeading();
+
+    /** Starts reporting readings (always works). */
+    bool start() { _running = true; return true; }
+
+    /** Returns true once started. */
+    bool isRunning() const { return _running; }
+
+    /**
+     * Sets the reading to report.
+     *
+     * @param data The values the sensor reports (heading is put in
+     * the range of [0, 360)).
+     */
+    void setData(const GyroData& data);
+
+    /** Sets just the heading reported (degrees). */
+    void setHeading(float heading);
+
+    /**
+     * Simulates the sensor dropping off the bus (getLatest() fails
+     * while not responding).
+     */
+    void setResponding(bool responding) { _responding = responding; }
+
+    /**
+     * Gets the reading last set (time stamped with the current time).
+     *
+     * @return true if started and responding.
+     */
+    bool getLatest(GyroSample& sample, int64_t maxAgeNanos = 0) const;
+
+    /** Number of calls to getLatest() which failed. */
+    uint32_t getFailures() const { return _failures; }
+
+    /** There are no reads to time. */
+    int64_t getMaxReadNanos() const { return 0; }
+
+  private:
+    GyroData _data;
+    uint32_t _count;
+    bool _running;
+    bool _responding;
+    mutable uint32_t _failures;
+  };
+
+  /**
+   * A vision source which returns the frames published to it (in the
+   * same process) since the prior drain().
+   */
+  class MemoryVision {
+
+  public:
+    MemoryVision();
+
+    /** Always succeeds (path is ignored). */
+    bool open(const std::string& path) { _open = true; return true; }
+
+    /** Stops returning frames. */
+    void close() { _open = false; }
+
+    /** Returns true if opened. */
+    bool isOpen() const { return _open; }
+
+    /**
+     * Adds a frame (the frame count is assigned for you like
+     * VisionWriter does).
+     *
+     * @param data Results of processing the frame.
+     * @param timeNanos CLOCK_MONOTONIC time the frame was captured.
+     */
+    void publish(const FileData& data, int64_t timeNanos);
+
+    /**
+     * Adds a frame exactly as given (keeps its frame count, used to
+     * replay recorded frames).
+     */
+    void publish(const VisionFrame& frame);
+
+    /**
+     * Copies the frames published since the prior call (oldest first).
+     *
+     * @return Number of frames copied or -1 if not open.
+     */
+    int drain(VisionFrame* frames, int maxFrames);
+
+    /** Skip over all frames except the most recent one. */
+    void skipToLatest();
+
+    /** Frames overwritten before they were drained. */
+    unsigned getLostFrames() const { return _lost; }
+
+  private:
+    bool _open;
+    int _frameCount;
+    uint32_t _head;
+    uint32_t _tail;
+    unsigned _lost;
+    VisionFrame _frames[VisionRing::CAPACITY];
+  };
+
+  /**
+   * LEDs which only remember the state or pattern last set (shared by
+   * simulations running on several threads, hence the atomics).
+   */
+  class MemoryLeds {
+
+  public:
+    /** Same patterns as UserLeds. */
+    enum Pattern {
+      NONE = 0,
+      BLINK = 1,
+      CHASE = 2,
+      HEARTBEAT = 3
+    };
+
+    /** Get access to the single instance. */
+    static MemoryLeds& getInstance() { return instance; }
+
+    /** Set the state of all four LEDs (stops any pattern). */
+    bool setState(int newState) {
+      __atomic_store_n(&_state, newState & 0xf, __ATOMIC_RELAXED);
+      __atomic_store_n(&_pattern, NONE, __ATOMIC_RELAXED);
+      return true;
+    }
+
+    /** Return the last state set. */
+    int getState() const { return __atomic_load_n(&_state, __ATOMIC_RELAXED); }
+
+    /** Set the state of a specific LED (in the range of [0, 3]). */
+    bool setLed(int led, bool turnOn);
+
+    /** Query the last state set of individual LED. */
+    bool isLedOn(int led) const { return (getState() & (1 << led)) != 0; }
+
+    /** Select a pattern. */
+    bool setPattern(Pattern pattern, int periodMillis = 1000) {
+      __atomic_store_n(&_pattern, pattern, __ATOMIC_RELAXED);
+      return true;
+    }
+
+    /** Returns the pattern last selected. */
+    Pattern getPattern() const { return __atomic_load_n(&_pattern, __ATOMIC_RELAXED); }
+
+    /** Flashes LEDs (stops any pattern). */
+    bool flash(int leds, int onMillis) {
+      __atomic_store_n(&_pattern, NONE, __ATOMIC_RELAXED);
+      return true;
+    }
+
+    /** Nothing to wait for. */
+    void flush() {
+    }
+
+  private:
+    MemoryLeds();
+    MemoryLeds(const MemoryLeds&);
+
+    static MemoryLeds instance;
+
+    int _state;
+    Pattern _pattern;
+  };
+
+  /**
+   * A button whose state is set by the program (never reports edges,
+   * so it must be polled with read()).
+   */
+  class MemoryButton : public Reactor::Handler {
+
+  public:
+    /** Never added to a reactor (no file descriptor). */
+    static const uint32_t EVENTS = 0;
+
+    /**
+     * Construct a new instance (initially not pressed).
+     *
+     * @param id Which button.
+     */
+    MemoryButton(ButtonId id);
+
+    /** No file descriptor (Reactor::add ignores it). */
+    int getFd() const { return -1; }
+
+    /** Button must be polled. */
+    bool hasEdges() const { return false; }
+
+    /** Returns the value at the last read(). */
+    bool isHigh() const { return _high; }
+
+    /** Picks up the value last set. */
+    bool read() { _high = _value; return true; }
+
+    /** Sets the value the next read() will see. */
+    void setHigh(bool high) { _value = high; }
+
+    void onEvent(uint32_t events) {
+    }
+
+  private:
+    ButtonId _id;
+    bool _value;
+    bool _high;
+  };
+
+  /**
+   * HAL backend with in-memory devices (see Hal.h).
+   */
+  struct MemoryHal {
+    typedef MemoryMotor Motor;
+    typedef MemoryHeading HeadingSensor;
+    typedef MemoryVision VisionSource;
+    typedef MemoryLeds Leds;
+    typedef MemoryButton Button;
+  };
+
+}
+
+#endif
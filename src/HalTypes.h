@@ -0,0 +1,26 @@
+/**
+ * Definition of the types shared by all of the HAL backends.
+ */
+#ifndef __avc_HalTypes_h
+#define __avc_HalTypes_h
+
+namespace avc {
+
+  /** Which side of the car a motor drives. */
+  enum MotorSide {
+    LEFT_MOTOR = 0,
+    RIGHT_MOTOR = 1
+  };
+
+  /** The buttons used to start an autonomous run. */
+  enum ButtonId {
+    /** Starts the run for the long path around the track. */
+    LONG_BUTTON = 0,
+
+    /** Starts the run for the short path around the track. */
+    SHORT_BUTTON = 1
+  };
+
+}
+
+#endif
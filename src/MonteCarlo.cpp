@@ -0,0 +1,223 @@
+/**
+ * Implementation of the MonteCarlo class.
+ */
+
+#include "MonteCarlo.h"
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <random>
+#include <thread>
+
+using namespace avc;
+using namespace std;
+
+namespace {
+  // How many of the places runs were cut short to list per configuration
+  const int maxEndPaths = 5;
+
+  double percent(int count, int total) {
+    return (total > 0) ? (1000 * count / total) / 10.0 : 0;
+  }
+
+  // Value at a fraction of the way through sorted values
+  float percentile(const vector<float>& sorted, float fraction) {
+    size_t i = (size_t) (fraction * (sorted.size() - 1) + 0.5f);
+    return sorted[min(i, sorted.size() - 1)];
+  }
+
+  bool moreRuns(const pair<string, int>& a, const pair<string, int>& b) {
+    return (a.second > b.second) || ((a.second == b.second) && (a.first < b.first));
+  }
+}
+
+MonteCarlo::MonteCarlo(bool longWay, int rateHz, float maxSecs) :
+  _longWay(longWay),
+  _rateHz(rateHz),
+  _maxSecs(maxSecs),
+  _runsPerConfig(0),
+  _firstSeed(1),
+  _jitter(0),
+  _wallSecs(0),
+  _recordPath(),
+  _configs(),
+  _outcomes(),
+  _nextRun(0)
+{
+}
+
+void MonteCarlo::addConfig(const SimConfig& config) {
+  _configs.push_back(config);
+}
+
+void MonteCarlo::run(int runsPerConfig, uint32_t firstSeed, int threads, float jitter) {
+  RealClock wallClock;
+  int64_t startNanos = wallClock.nowNanos();
+
+  _runsPerConfig = max(1, runsPerConfig);
+  _firstSeed = firstSeed;
+  _jitter = jitter;
+  _outcomes.assign(_configs.size() * _runsPerConfig, SimOutcome());
+  _nextRun = 0;
+
+  if (threads <= 0) {
+    threads = max(1, (int) thread::hardware_concurrency());
+  }
+  threads = min(threads, (int) _outcomes.size());
+
+  if (threads <= 1) {
+    worker();
+  } else {
+    vector<thread> pool;
+    for (int i = 0; i < threads; i++) {
+      pool.push_back(thread(&MonteCarlo::worker, this));
+    }
+    for (size_t i = 0; i < pool.size(); i++) {
+      pool[i].join();
+    }
+  }
+
+  _wallSecs = (wallClock.nowNanos() - startNanos) / 1e9;
+}
+
+void MonteCarlo::worker() {
+  const int runs = (int) _outcomes.size();
+  int index;
+  while ((index = _nextRun.fetch_add(1)) < runs) {
+    runOne(index);
+  }
+}
+
+void MonteCarlo::runOne(int index) {
+  const int configIndex = index / _runsPerConfig;
+  const SimConfig& config = _configs[configIndex];
+
+  SimParams params(config.params);
+  params.seed = _firstSeed + (index % _runsPerConfig);
+
+  if (_jitter > 0) {
+    // Vary the car itself (independent of the sensor noise stream)
+    mt19937 random(params.seed ^ 0x5eed5eedU);
+    uniform_real_distribution<float> spread(-_jitter, _jitter);
+    params.maxSpeed *= 1 + spread(random);
+    params.motorLagSecs *= 1 + spread(random);
+    params.brakeLagSecs *= 1 + spread(random);
+    params.turnScrub *= 1 + spread(random);
+    params.gyroDriftDegPerSec *= 1 + spread(random);
+    params.cameraLatencySecs *= 1 + spread(random);
+  }
+
+  // A fresh car for every run so nothing carries over between runs
+  Timon timon;
+  timon.setTuning(config.tuning);
+  if ((index == 0) && !_recordPath.empty()) {
+    timon.openSensorRecorder(_recordPath);
+  }
+  Simulator sim(timon, params);
+
+  if (_longWay) {
+    timon.setAutonLongWay();
+  } else {
+    timon.setAutonShortWay();
+  }
+  Command::State state = sim.run(timon, _rateHz, _maxSecs);
+  timon.disable();
+
+  SimOutcome& outcome = _outcomes[index];
+  outcome.config = configIndex;
+  outcome.seed = params.seed;
+  outcome.state = state;
+  outcome.crashed = timon.hasCrashed();
+  outcome.secs = sim.getSecs();
+  outcome.corners = sim.getCornersReached();
+  outcome.collisions = sim.getCollisions();
+  outcome.maxOffLine = sim.getMaxOffLine();
+  outcome.endPath[0] = '\0';
+  if (!outcome.isFinished()) {
+    strncpy(outcome.endPath, sim.getEndPath(), sizeof(outcome.endPath) - 1);
+    outcome.endPath[sizeof(outcome.endPath) - 1] = '\0';
+  }
+}
+
+ostream& MonteCarlo::printSummary(ostream& out) const {
+  for (size_t c = 0; c < _configs.size(); c++) {
+    int runs = 0;
+    int crashed = 0;
+    int timedOut = 0;
+    double corners = 0;
+    double collisions = 0;
+    double offLine = 0;
+    vector<float> lapSecs;
+    map<string, int> endPaths;
+
+    for (size_t i = c * _runsPerConfig; i < (c + 1) * _runsPerConfig; i++) {
+      const SimOutcome& outcome = _outcomes[i];
+      runs++;
+      corners += outcome.corners;
+      collisions += outcome.collisions;
+      offLine += outcome.maxOffLine;
+
+      if (outcome.isFinished()) {
+        lapSecs.push_back(outcome.secs);
+        continue;
+      }
+      if (outcome.crashed) {
+        crashed++;
+      } else if (outcome.state == Command::TIMED_OUT) {
+        timedOut++;
+      }
+      endPaths[(outcome.endPath[0] != '\0') ? outcome.endPath : "(none)"]++;
+    }
+
+    const SimConfig& config = _configs[c];
+    out << (config.label.empty() ? "defaults" : config.label) << ": " << runs << " runs, "
+        << percent(lapSecs.size(), runs) << "% finished, "
+        << percent(crashed, runs) << "% crashed, "
+        << percent(timedOut, runs) << "% timed out\n";
+
+    if (!lapSecs.empty()) {
+      sort(lapSecs.begin(), lapSecs.end());
+      double sum = 0;
+      for (size_t i = 0; i < lapSecs.size(); i++) {
+        sum += lapSecs[i];
+      }
+      out << "  lap secs: mean=" << (sum / lapSecs.size())
+          << " min=" << lapSecs.front()
+          << " p50=" << percentile(lapSecs, 0.5f)
+          << " p90=" << percentile(lapSecs, 0.9f)
+          << " max=" << lapSecs.back() << "\n";
+    }
+
+    out << "  mean corners=" << (corners / runs) << " collisions=" << (collisions / runs)
+        << " maxOffLine=" << (offLine / runs) << "\n";
+
+    if (!endPaths.empty()) {
+      vector<pair<string, int> > sorted(endPaths.begin(), endPaths.end());
+      sort(sorted.begin(), sorted.end(), moreRuns);
+      out << "  cut short in:";
+      for (size_t i = 0; (i < sorted.size()) && (i < maxEndPaths); i++) {
+        out << " " << sorted[i].first << " (" << sorted[i].second << ")";
+      }
+      out << "\n";
+    }
+  }
+  return out;
+}
+
+ostream& MonteCarlo::printOutcomes(ostream& out) const {
+  for (size_t i = 0; i < _outcomes.size(); i++) {
+    const SimOutcome& outcome = _outcomes[i];
+    out << "config=" << outcome.config << " seed=" << outcome.seed
+        << " " << Command::stateToString(outcome.state)
+        << (outcome.crashed ? " CRASHED" : "")
+        << " secs=" << outcome.secs << " corners=" << outcome.corners
+        << " collisions=" << outcome.collisions
+        << " maxOffLine=" << outcome.maxOffLine;
+    if (outcome.endPath[0] != '\0') {
+      out << " endPath=" << outcome.endPath;
+    }
+    out << "\n";
+  }
+  return out;
+}
@@ -0,0 +1,147 @@
+/**
+ * Definition of the MonteCarlo class (runs many simulated autons on
+ * all cores and summarizes how they went).
+ */
+#ifndef __avc_MonteCarlo_h
+#define __avc_MonteCarlo_h
+
+#include "Simulator.h"
+
+#include <atomic>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+
+namespace avc {
+
+  /**
+   * A set of values to evaluate (each gets the same number of runs).
+   */
+  struct SimConfig {
+    // What was changed from the defaults (like "straightP=0.05")
+    std::string label;
+    TimonTuning tuning;
+    SimParams params;
+  };
+
+  /**
+   * Outcome of a single simulated run.
+   */
+  struct SimOutcome {
+    // Which configuration and noise seed
+    int config;
+    uint32_t seed;
+
+    Command::State state;
+    bool crashed;
+    // Simulated seconds until the auton ended
+    float secs;
+    int corners;
+    int collisions;
+    float maxOffLine;
+    // Command active when the run was cut short (timed out)
+    char endPath[64];
+
+    /** True if the auton ran to completion without crashing. */
+    bool isFinished() const {
+      return (state == Command::NORMAL_END) && !crashed;
+    }
+  };
+
+  /**
+   * Runs each configuration with a range of noise seeds across a
+   * pool of threads (each run gets its own Timon, Simulator and
+   * virtual clock, so results do not depend on how the runs were
+   * scheduled).
+   *
+   * <pre>
+   * MonteCarlo mc(false, 20, 120);
+   * SimConfig config;
+   * config.label = "straightP=0.05";
+   * config.tuning.straightP = 0.05;
+   * mc.addConfig(config);
+   * mc.run(1000, 1, 0, 0.1);
+   * mc.printSummary(cout);
+   * </pre>
+   */
+  class MonteCarlo {
+
+  public:
+    /**
+     * @param longWay Run the long (true) or short (false) path.
+     * @param rateHz Control loop rate (simulated).
+     * @param maxSecs Simulated seconds before giving up on a run.
+     */
+    MonteCarlo(bool longWay, int rateHz, float maxSecs);
+
+    /** Adds a configuration to evaluate. */
+    void addConfig(const SimConfig& config);
+
+    /**
+     * Records the sensor readings of the first run (so it can be
+     * replayed with avc-replay).
+     *
+     * @param path The file to record to (empty to not record).
+     */
+    void setRecordPath(const std::string& path) { _recordPath = path; }
+
+    /** Number of configurations added. */
+    int getConfigCount() const { return (int) _configs.size(); }
+
+    /**
+     * Runs all of the configurations.
+     *
+     * @param runsPerConfig How many seeds to run each configuration with.
+     * @param firstSeed The seed of the first run (seeds are consecutive).
+     * @param threads How many threads to use (0 for one per core).
+     * @param jitter Randomly scale the car's physical constants
+     * (speed, lags, scrub, drift, latency) by up to this fraction on
+     * each run (0 to always use the configured values).
+     */
+    void run(int runsPerConfig, uint32_t firstSeed, int threads, float jitter);
+
+    /** Outcome of each run (in configuration and seed order). */
+    const std::vector<SimOutcome>& getOutcomes() const { return _outcomes; }
+
+    /** Wall clock seconds the last run() took. */
+    double getWallSecs() const { return _wallSecs; }
+
+    /**
+     * Writes the lap times, crash rate and where runs timed out for
+     * each configuration.
+     */
+    std::ostream& printSummary(std::ostream& out) const;
+
+    /** Writes one line per run. */
+    std::ostream& printOutcomes(std::ostream& out) const;
+
+  private:
+    MonteCarlo(const MonteCarlo&);
+
+    // Takes runs off the queue until there are none left
+    void worker();
+
+    // Simulates one run
+    void runOne(int index);
+
+    bool _longWay;
+    int _rateHz;
+    float _maxSecs;
+    int _runsPerConfig;
+    uint32_t _firstSeed;
+    float _jitter;
+    double _wallSecs;
+    std::string _recordPath;
+
+    std::vector<SimConfig> _configs;
+    std::vector<SimOutcome> _outcomes;
+
+    // Index of the next run to hand to a worker
+    std::atomic<int> _nextRun;
+  };
+
+}
+
+#endif
@@ -0,0 +1,106 @@
+/**
+ * Implementation of the PeriodicTimer class.
+ */
+
+#include "Clock.h"
+#include "PeriodicTimer.h"
+#include "Reactor.h"
+
+using namespace avc;
+
+PeriodicTimer::PeriodicTimer(int64_t periodNanos) :
+  _periodNanos((periodNanos > 0) ? periodNanos : 1),
+  _deadline(0),
+  _ticks(0),
+  _missed(0),
+  _lastLateNanos(0),
+  _maxLateNanos(0),
+  _sumLateNanos(0)
+{
+}
+
+int64_t PeriodicTimer::nowNanos() {
+  // Real clock is the same clock the Reactor's timerfd uses
+  return Clock::nowNanos();
+}
+
+void PeriodicTimer::start() {
+  _ticks = 0;
+  _missed = 0;
+  _lastLateNanos = 0;
+  _maxLateNanos = 0;
+  _sumLateNanos = 0;
+  _deadline = nowNanos() + _periodNanos;
+}
+
+int PeriodicTimer::waitForNext() {
+  int64_t now = nowNanos();
+
+  if (now > _deadline) {
+    return skipMissed(now);
+  }
+
+  // Absolute sleeps can simply be restarted if a signal arrives
+  while (Clock::sleepUntil(_deadline) > 0) {
+  }
+
+  recordTick(nowNanos(), 0);
+  return 0;
+}
+
+bool PeriodicTimer::waitForNextOrEvent(Reactor& reactor) {
+  int64_t now = nowNanos();
+
+  if (now > _deadline) {
+    skipMissed(now);
+    return true;
+  }
+
+  if (Clock::isVirtual()) {
+    // Time won't pass while waiting on file descriptors (simulated
+    // sensors are updated between ticks), just jump to the deadline
+    Clock::sleepUntil(_deadline);
+    recordTick(nowNanos(), 0);
+    return true;
+  }
+
+  // Reactor uses the same clock (CLOCK_MONOTONIC) as our deadlines
+  if ((reactor.waitUntil(_deadline) > 0) && ((now = nowNanos()) < _deadline)) {
+    return false;
+  }
+
+  recordTick(nowNanos(), 0);
+  return true;
+}
+
+int PeriodicTimer::skipMissed(int64_t now) {
+  // Still busy when deadline passed, skip any periods we fell
+  // completely behind on to stay in phase
+  int missed = 1 + (int) ((now - _deadline) / _periodNanos);
+  _deadline += (missed - 1) * _periodNanos;
+  recordTick(now, missed);
+  return missed;
+}
+
+void PeriodicTimer::recordTick(int64_t now, int missed) {
+  int64_t late = now - _deadline;
+  _lastLateNanos = late;
+  _sumLateNanos += late;
+  if (late > _maxLateNanos) {
+    _maxLateNanos = late;
+  }
+
+  _ticks++;
+  _missed += missed;
+  _deadline += _periodNanos;
+}
+
+std::ostream& PeriodicTimer::print(std::ostream& out) const {
+  out << "PeriodicTimer(periodNanos=" << _periodNanos
+      << ", ticks=" << _ticks
+      << ", missed=" << _missed
+      << ", avgLateNanos=" << getAvgLateNanos()
+      << ", maxLateNanos=" << _maxLateNanos
+      << ")";
+  return out;
+}
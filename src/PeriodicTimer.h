@@ -0,0 +1,164 @@
+/**
+ * Definition of the PeriodicTimer used to fire code at a fixed rate.
+ */
+#ifndef __avc_PeriodicTimer_h
+#define __avc_PeriodicTimer_h
+
+#include <iostream>
+
+#include <stdint.h>
+#include <time.h>
+
+namespace avc {
+
+  class Reactor;
+
+  /**
+   * PeriodicTimer sleeps until absolute deadlines (start + N * period)
+   * using clock_nanosleep(TIMER_ABSTIME) so a long running tick does
+   * not shift the phase of every tick after it.
+   *
+   * <p>Each call to {@link #waitForNext} records how late we woke up
+   * relative to the deadline and counts deadlines that were missed
+   * entirely (the caller was still busy when the deadline passed).</p>
+   *
+   * <pre>
+   * PeriodicTimer timer(1000000000 / 100); // 100 Hz
+   * timer.start();
+   *
+   * while (continueRunning()) {
+   *   foo();
+   *   timer.waitForNext();
+   * }
+   * timer.print(cout) << "\n";
+   * </pre>
+   */
+  class PeriodicTimer {
+
+  public:
+    /**
+     * Construct a new instance (call {@link #start} before waiting).
+     *
+     * @param periodNanos The number of nanoseconds between each
+     * deadline (may be larger than one second).
+     */
+    PeriodicTimer(int64_t periodNanos);
+
+    /**
+     * Constructs a timer based on a rate in Hz.
+     *
+     * @param rateHz How many times per second the deadline should fire.
+     */
+    static PeriodicTimer fromRate(int rateHz) {
+      return PeriodicTimer(1000000000LL / ((rateHz > 0) ? rateHz : 1));
+    }
+
+    /**
+     * Clears all of the statistics and sets the first deadline one
+     * period from now.
+     */
+    void start();
+
+    /**
+     * Sleeps until the next deadline.
+     *
+     * <p>If the deadline has already passed, we do not sleep and the
+     * missed count is incremented. Deadlines that passed by more than
+     * a full period are skipped (and counted as missed) so we stay in
+     * phase with the original start time instead of trying to "catch
+     * up" with a burst of back to back ticks.</p>
+     *
+     * @return The number of deadlines missed since the prior call (0
+     * if we were on time).
+     */
+    int waitForNext();
+
+    /**
+     * Waits for the next deadline, but returns early if the reactor
+     * dispatches an event before the deadline arrives.
+     *
+     * <p>Waking early does not shift the deadlines or count as a
+     * tick, the next call continues to wait for the same deadline.</p>
+     *
+     * @param reactor The Reactor to wait on (it dispatches any events
+     * to their handlers before this method returns).
+     *
+     * @return true if the deadline was reached (tick statistics were
+     * updated), false if woken early by an event.
+     */
+    bool waitForNextOrEvent(Reactor& reactor);
+
+    /**
+     * Returns the length of each period in nanoseconds.
+     */
+    int64_t getPeriodNanos() const { return _periodNanos; }
+
+    /**
+     * Returns how many times {@link #waitForNext} has been invoked.
+     */
+    int getTicks() const { return _ticks; }
+
+    /**
+     * Returns the total number of deadlines missed since started.
+     */
+    int getMissed() const { return _missed; }
+
+    /**
+     * Returns how late (in nanoseconds) the last tick started after
+     * its deadline.
+     */
+    int64_t getLastLateNanos() const { return _lastLateNanos; }
+
+    /**
+     * Returns the worst lateness (in nanoseconds) seen since started.
+     */
+    int64_t getMaxLateNanos() const { return _maxLateNanos; }
+
+    /**
+     * Returns the average lateness (in nanoseconds) of all ticks.
+     */
+    int64_t getAvgLateNanos() const {
+      return (_ticks > 0) ? (_sumLateNanos / _ticks) : 0;
+    }
+
+    /**
+     * Dumps the tick statistics to the output stream provided.
+     */
+    std::ostream& print(std::ostream& out) const;
+
+  private:
+    // Gets the current time on the clock used for the deadlines
+    static int64_t nowNanos();
+
+    // Skips deadlines we were too busy to meet, returns number missed
+    int skipMissed(int64_t now);
+
+    // Updates statistics for a tick and advances to next deadline
+    void recordTick(int64_t now, int missed);
+
+    // Length of each period
+    int64_t _periodNanos;
+    // Absolute time (CLOCK_MONOTONIC nanoseconds) of next deadline
+    int64_t _deadline;
+    // Number of times waitForNext() has been called
+    int _ticks;
+    // Number of deadlines we were not able to meet
+    int _missed;
+    // Lateness of most recent tick
+    int64_t _lastLateNanos;
+    // Worst lateness seen
+    int64_t _maxLateNanos;
+    // Sum of all lateness values (for average)
+    int64_t _sumLateNanos;
+  };
+
+  //
+  // inline methods
+  //
+
+  inline std::ostream& operator <<(std::ostream& out, const PeriodicTimer& timer) {
+    return timer.print(out);
+  }
+}
+
+#endif
@@ -0,0 +1,82 @@
+/**
+ * Implementation of the Pid class.
+ */
+
+#include "Pid.h"
+
+using namespace avc;
+
+namespace {
+  float clamp(float val, float maxMag) {
+    if (maxMag <= 0) {
+      return val;
+    }
+    return (val > maxMag) ? maxMag : ((val < -maxMag) ? -maxMag : val);
+  }
+}
+
+Pid::Pid(float p, float i, float d) :
+  _p(p),
+  _i(i),
+  _d(d),
+  _filterSecs(0),
+  _maxIntegral(0),
+  _maxOutput(0),
+  _primed(false),
+  _lastErr(0),
+  _lastNanos(0),
+  _errRate(0),
+  _integral(0)
+{
+}
+
+void Pid::setGains(float p, float i, float d) {
+  _p = p;
+  _i = i;
+  _d = d;
+}
+
+void Pid::setDerivativeFilter(float secs) {
+  _filterSecs = (secs > 0) ? secs : 0;
+}
+
+void Pid::setIntegralLimit(float maxMag) {
+  _maxIntegral = maxMag;
+}
+
+void Pid::setOutputLimit(float maxMag) {
+  _maxOutput = maxMag;
+}
+
+void Pid::reset() {
+  _primed = false;
+  _lastErr = 0;
+  _lastNanos = 0;
+  _errRate = 0;
+  _integral = 0;
+}
+
+float Pid::update(float err, int64_t nanos) {
+  // Several updates in the same tick (or the first one) can't measure
+  // a rate, the prior rate and integral stand
+  float dt = _primed ? (nanos - _lastNanos) / 1e9f : 0;
+
+  if (dt > 0) {
+    float rate = (err - _lastErr) / dt;
+    if (_filterSecs > 0) {
+      // First order low pass (same response whatever the update rate)
+      _errRate += (rate - _errRate) * (dt / (_filterSecs + dt));
+    } else {
+      _errRate = rate;
+    }
+    _integral = clamp(_integral + _i * err * dt, _maxIntegral);
+  }
+
+  if ((dt > 0) || !_primed) {
+    _lastErr = err;
+    _lastNanos = nanos;
+    _primed = true;
+  }
+
+  return clamp(_p * err + _integral + _d * _errRate, _maxOutput);
+}
@@ -0,0 +1,111 @@
+/**
+ * Definition of the Pid class (feedback controller which works from
+ * the measured time between updates).
+ */
+#ifndef __avc_Pid_h
+#define __avc_Pid_h
+
+#include <stdint.h>
+
+namespace avc {
+
+  /**
+   * PID controller whose gains are per second (not per call) so the
+   * same gains work at any control loop rate.
+   *
+   * <p>Each update is handed the time stamp of the reading (normally
+   * the time stamp of the control loop tick) and the controller uses
+   * the time since the prior update. The derivative can be run through
+   * a low pass filter (useful at high loop rates where the change
+   * between readings is mostly noise) and the integral and output can
+   * be clamped.</p>
+   *
+   * <pre>
+   * Pid pid(0.04, 0, 0.00125);
+   * pid.setDerivativeFilter(0.02);
+   * pid.reset();
+   *
+   * // Each tick
+   * float adjust = pid.update(err, Clock::nowNanos());
+   * </pre>
+   */
+  class Pid {
+
+  public:
+    /**
+     * Constructs a controller (no filtering or limits).
+     *
+     * @param p Gain applied to the error.
+     * @param i Gain applied to the error integrated over seconds.
+     * @param d Gain applied to the change in error per second.
+     */
+    Pid(float p = 0, float i = 0, float d = 0);
+
+    /** Changes the gains (keeps the current state). */
+    void setGains(float p, float i, float d);
+
+    /**
+     * Sets the time constant of the low pass filter applied to the
+     * derivative.
+     *
+     * @param secs Time constant in seconds (0 to use the raw change
+     * between updates).
+     */
+    void setDerivativeFilter(float secs);
+
+    /**
+     * Limits the magnitude of the integral term (to keep it from
+     * winding up while the output is saturated).
+     *
+     * @param maxMag Largest magnitude of the integral term (0 for no
+     * limit).
+     */
+    void setIntegralLimit(float maxMag);
+
+    /**
+     * Limits the magnitude of the output.
+     *
+     * @param maxMag Largest magnitude of the output (0 for no limit).
+     */
+    void setOutputLimit(float maxMag);
+
+    /**
+     * Forgets the prior error, derivative and integral. The next
+     * update only establishes the prior error (no derivative).
+     */
+    void reset();
+
+    /**
+     * Computes the output for a new error.
+     *
+     * @param err The error (desired - measured).
+     * @param nanos Time stamp of the reading (see Clock::nowNanos).
+     *
+     * @return The (limited) output.
+     */
+    float update(float err, int64_t nanos);
+
+    /** Filtered change in error per second as of the last update. */
+    float getErrRate() const { return _errRate; }
+
+    /** Current value of the integral term (already multiplied by its gain). */
+    float getIntegral() const { return _integral; }
+
+  private:
+    float _p;
+    float _i;
+    float _d;
+    float _filterSecs;
+    float _maxIntegral;
+    float _maxOutput;
+
+    bool _primed;
+    float _lastErr;
+    int64_t _lastNanos;
+    float _errRate;
+    float _integral;
+  };
+
+}
+
+#endif
@@ -0,0 +1,268 @@
+/**
+ * Implementation of the Reactor and event source classes.
+ */
+
+#include "Reactor.h"
+
+#include <iostream>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/signalfd.h>
+#include <sys/stat.h>
+#include <sys/timerfd.h>
+#include <time.h>
+#include <unistd.h>
+
+using namespace avc;
+using namespace std;
+
+namespace {
+  const int64_t nanosPerSec = 1000000000LL;
+
+  // Maximum number of events to pull in per epoll_wait() call
+  const int maxEvents = 8;
+
+  int64_t nowNanos() {
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * nanosPerSec + now.tv_nsec;
+  }
+}
+
+//
+// Reactor class
+//
+
+Reactor::Reactor() :
+  _epollFd(epoll_create1(EPOLL_CLOEXEC)),
+  _timerFd(timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC))
+{
+  if (!isOpen()) {
+    cerr << "***ERROR*** Failed to create epoll/timer file descriptors\n";
+    return;
+  }
+
+  // Timer is dispatched specially (null handler)
+  epoll_event ev;
+  ev.events = EPOLLIN;
+  ev.data.ptr = 0;
+  epoll_ctl(_epollFd, EPOLL_CTL_ADD, _timerFd, &ev);
+}
+
+Reactor::~Reactor() {
+  if (_timerFd >= 0) {
+    ::close(_timerFd);
+  }
+  if (_epollFd >= 0) {
+    ::close(_epollFd);
+  }
+}
+
+bool Reactor::add(int fd, uint32_t events, Handler& handler) {
+  if (fd < 0) {
+    return false;
+  }
+  epoll_event ev;
+  ev.events = events;
+  ev.data.ptr = &handler;
+  return epoll_ctl(_epollFd, EPOLL_CTL_ADD, fd, &ev) == 0;
+}
+
+bool Reactor::remove(int fd) {
+  // Older kernels require a non-null event pointer for EPOLL_CTL_DEL
+  epoll_event ev;
+  ev.events = 0;
+  ev.data.ptr = 0;
+  return epoll_ctl(_epollFd, EPOLL_CTL_DEL, fd, &ev) == 0;
+}
+
+bool Reactor::armTimer(int64_t deadlineNanos) {
+  itimerspec spec;
+  spec.it_interval.tv_sec = 0;
+  spec.it_interval.tv_nsec = 0;
+  spec.it_value.tv_sec = (time_t) (deadlineNanos / nanosPerSec);
+  spec.it_value.tv_nsec = (long) (deadlineNanos % nanosPerSec);
+
+  if (deadlineNanos <= 0) {
+    // All zeros disarms the timer
+    spec.it_value.tv_sec = 0;
+    spec.it_value.tv_nsec = 0;
+  }
+  return timerfd_settime(_timerFd, TFD_TIMER_ABSTIME, &spec, 0) == 0;
+}
+
+int Reactor::wait(int64_t timeoutNanos) {
+  return waitUntil((timeoutNanos < 0) ? 0 : nowNanos() + timeoutNanos);
+}
+
+int Reactor::waitUntil(int64_t deadlineNanos) {
+  bool forever = (deadlineNanos <= 0);
+  if (!forever && (deadlineNanos <= nowNanos())) {
+    return 0;
+  }
+  armTimer(deadlineNanos);
+
+  epoll_event events[maxEvents];
+  int dispatched = 0;
+  bool timedOut = false;
+
+  while ((dispatched == 0) && !timedOut) {
+    int n = epoll_wait(_epollFd, events, maxEvents, -1);
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      cerr << "***ERROR*** epoll_wait failed (errno=" << errno << ")\n";
+      break;
+    }
+
+    for (int i = 0; i < n; i++) {
+      Handler* handler = static_cast<Handler*>(events[i].data.ptr);
+      if (handler == 0) {
+        // Clear the timer expiration count
+        uint64_t expirations;
+        if (::read(_timerFd, &expirations, sizeof(expirations)) > 0) {
+          timedOut = true;
+        }
+      } else {
+        handler->onEvent(events[i].events);
+        dispatched++;
+      }
+    }
+  }
+
+  if (!timedOut && !forever) {
+    armTimer(0);
+  }
+  return dispatched;
+}
+
+//
+// SignalSource class
+//
+
+SignalSource::SignalSource(bool* flag) :
+  _fd(-1),
+  _signaled(false),
+  _flag(flag)
+{
+  sigemptyset(&_mask);
+  sigaddset(&_mask, SIGINT);
+  sigaddset(&_mask, SIGTERM);
+
+  if (sigprocmask(SIG_BLOCK, &_mask, 0) == 0) {
+    _fd = signalfd(-1, &_mask, SFD_NONBLOCK | SFD_CLOEXEC);
+  }
+  if (_fd < 0) {
+    cerr << "***ERROR*** Failed to create signalfd for SIGINT/SIGTERM\n";
+  }
+}
+
+SignalSource::~SignalSource() {
+  if (_fd >= 0) {
+    ::close(_fd);
+  }
+  sigprocmask(SIG_UNBLOCK, &_mask, 0);
+}
+
+void SignalSource::onEvent(uint32_t events) {
+  signalfd_siginfo info;
+  while (::read(_fd, &info, sizeof(info)) == sizeof(info)) {
+    _signaled = true;
+    if (_flag) {
+      *_flag = true;
+    }
+  }
+}
+
+//
+// NotifySource class
+//
+
+NotifySource::NotifySource() :
+  _fd(-1),
+  _isFifo(false),
+  _watched(false),
+  _pending(false)
+{
+}
+
+NotifySource::~NotifySource() {
+  close();
+}
+
+bool NotifySource::openFifo(const string& path) {
+  close();
+
+  struct stat info;
+  if ((stat(path.c_str(), &info) != 0) || !S_ISFIFO(info.st_mode)) {
+    return false;
+  }
+
+  // Opening read/write means we never see EOF when the writer goes away
+  _fd = ::open(path.c_str(), O_RDWR | O_NONBLOCK | O_CLOEXEC);
+  _isFifo = true;
+  return isOpen();
+}
+
+bool NotifySource::openEventFd() {
+  close();
+  _fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  _isFifo = false;
+  return isOpen();
+}
+
+void NotifySource::close() {
+  if (_fd >= 0) {
+    ::close(_fd);
+  }
+  _fd = -1;
+  _pending = false;
+}
+
+void NotifySource::notify() {
+  if (_fd < 0) {
+    return;
+  }
+  // Never blocks, if the FIFO is full the consumer already has
+  // notifications pending
+  if (_isFifo) {
+    char c = 1;
+    (void) ::write(_fd, &c, 1);
+  } else {
+    uint64_t one = 1;
+    (void) ::write(_fd, &one, sizeof(one));
+  }
+}
+
+bool NotifySource::drain() {
+  bool gotSome = false;
+  if (_isFifo) {
+    char buf[64];
+    while (::read(_fd, buf, sizeof(buf)) > 0) {
+      gotSome = true;
+    }
+  } else {
+    uint64_t cnt;
+    gotSome = (::read(_fd, &cnt, sizeof(cnt)) == sizeof(cnt));
+  }
+  return gotSome;
+}
+
+bool NotifySource::consume() {
+  if ((_fd >= 0) && !_watched && drain()) {
+    _pending = true;
+  }
+  bool wasPending = _pending;
+  _pending = false;
+  return wasPending;
+}
+
+void NotifySource::onEvent(uint32_t events) {
+  if (drain()) {
+    _pending = true;
+  }
+}
@@ -0,0 +1,243 @@
+/**
+ * Definition of the Reactor (epoll based event dispatcher) and some
+ * common event sources.
+ */
+#ifndef __avc_Reactor_h
+#define __avc_Reactor_h
+
+#include <string>
+
+#include <signal.h>
+#include <stdint.h>
+
+namespace avc {
+
+  /**
+   * The Reactor waits on a set of file descriptors (using epoll) and
+   * dispatches to a Handler when one of them becomes ready.
+   *
+   * <p>It also owns a timerfd so a wait can be bounded by an absolute
+   * CLOCK_MONOTONIC deadline with nanosecond resolution (see
+   * PeriodicTimer::waitForNextOrEvent).</p>
+   *
+   * <pre>
+   * Reactor reactor;
+   * SignalSource signals;
+   * reactor.add(signals.getFd(), EPOLLIN, signals);
+   *
+   * while (!signals.hasBeenSignaled()) {
+   *   reactor.wait(-1);
+   * }
+   * </pre>
+   */
+  class Reactor {
+
+  public:
+    /**
+     * Interface for objects which want to be told when their file
+     * descriptor is ready.
+     */
+    class Handler {
+
+    public:
+      virtual ~Handler() {
+      }
+
+      /**
+       * Invoked by the Reactor when the file descriptor is ready.
+       *
+       * @param events The epoll event bits which were reported.
+       */
+      virtual void onEvent(uint32_t events) = 0;
+    };
+
+    /**
+     * Creates the epoll and timer file descriptors.
+     */
+    Reactor();
+
+    /**
+     * Closes the epoll and timer file descriptors (does not close the
+     * file descriptors which were added).
+     */
+    ~Reactor();
+
+    /**
+     * Returns true if the reactor was successfully constructed.
+     */
+    bool isOpen() const {
+      return (_epollFd >= 0) && (_timerFd >= 0);
+    }
+
+    /**
+     * Start watching a file descriptor.
+     *
+     * @param fd The file descriptor to watch.
+     *
+     * @param events The epoll events to watch for (like EPOLLIN or
+     * EPOLLPRI).
+     *
+     * @param handler The object to notify when the file descriptor is
+     * ready (must remain valid until removed or the reactor is
+     * destroyed).
+     *
+     * @return true if successfully added.
+     */
+    bool add(int fd, uint32_t events, Handler& handler);
+
+    /**
+     * Stop watching a file descriptor.
+     *
+     * @return true if successfully removed.
+     */
+    bool remove(int fd);
+
+    /**
+     * Waits for events to arrive or a timeout to expire.
+     *
+     * @param timeoutNanos How long to wait for an event (pass a
+     * negative value to wait forever).
+     *
+     * @return The number of events dispatched to handlers (0 if the
+     * wait timed out).
+     */
+    int wait(int64_t timeoutNanos);
+
+    /**
+     * Waits for events to arrive or an absolute deadline to pass.
+     *
+     * @param deadlineNanos The CLOCK_MONOTONIC time (in nanoseconds)
+     * to stop waiting at.
+     *
+     * @return The number of events dispatched to handlers (0 if the
+     * deadline was reached without any events).
+     */
+    int waitUntil(int64_t deadlineNanos);
+
+  private:
+    // Hide copy constructor (we own file descriptors)
+    Reactor(const Reactor&);
+
+    // Arms the timer (deadline <= 0 disarms it)
+    bool armTimer(int64_t deadlineNanos);
+
+    int _epollFd;
+    int _timerFd;
+  };
+
+  /**
+   * Event source which converts SIGINT and SIGTERM into a readable
+   * signalfd (the signals are blocked so they are only delivered
+   * through the file descriptor).
+   *
+   * <p>NOTE: Construct this before starting any threads so they
+   * inherit the blocked signal mask.</p>
+   */
+  class SignalSource : public Reactor::Handler {
+
+  public:
+    /**
+     * Blocks SIGINT and SIGTERM and creates the signalfd.
+     *
+     * @param flag Optional flag to set to true when a signal arrives.
+     */
+    SignalSource(bool* flag = 0);
+    ~SignalSource();
+
+    /** File descriptor to add to a Reactor (watch for EPOLLIN). */
+    int getFd() const { return _fd; }
+
+    /** Returns true once one of the signals has been received. */
+    bool hasBeenSignaled() const { return _signaled; }
+
+    /** Reads the pending signal information. */
+    void onEvent(uint32_t events);
+
+  private:
+    SignalSource(const SignalSource&);
+
+    sigset_t _mask;
+    int _fd;
+    bool _signaled;
+    bool* _flag;
+  };
+
+  /**
+   * Event source used by a producer to let a consumer know new data
+   * is available. It can be backed by a named FIFO (so a separate
+   * process can signal us) or an eventfd (within a process).
+   *
+   * <p>Notifications are coalesced, the consumer only learns that
+   * one or more notifications arrived since it last checked.</p>
+   */
+  class NotifySource : public Reactor::Handler {
+
+  public:
+    /**
+     * Constructs a closed instance (use one of the open methods).
+     */
+    NotifySource();
+    ~NotifySource();
+
+    /**
+     * Opens an existing named FIFO (does not create it).
+     *
+     * @param path Path to the FIFO (like "/dev/shm/stanchions.notify").
+     *
+     * @return true if opened.
+     */
+    bool openFifo(const std::string& path);
+
+    /**
+     * Creates an eventfd (for signaling within the same process).
+     *
+     * @return true if opened.
+     */
+    bool openEventFd();
+
+    /** Closes the file descriptor. */
+    void close();
+
+    /** Returns true if we have an open file descriptor. */
+    bool isOpen() const { return _fd >= 0; }
+
+    /** File descriptor to add to a Reactor (watch for EPOLLIN). */
+    int getFd() const { return _fd; }
+
+    /**
+     * Let the consumer know there is new data (never blocks).
+     */
+    void notify();
+
+    /**
+     * Indicate whether a Reactor is draining the file descriptor for
+     * us (if not, {@link #consume} reads the file descriptor itself).
+     */
+    void setWatched(bool watched) { _watched = watched; }
+
+    /**
+     * Checks for (and clears) any notifications received.
+     *
+     * @return true if one or more notifications arrived since the
+     * last call.
+     */
+    bool consume();
+
+    /** Drains the file descriptor and marks a notification pending. */
+    void onEvent(uint32_t events);
+
+  private:
+    NotifySource(const NotifySource&);
+
+    // Reads everything available, returns true if anything was read
+    bool drain();
+
+    int _fd;
+    bool _isFifo;
+    bool _watched;
+    bool _pending;
+  };
+
+}
+
+#endif
@@ -0,0 +1,115 @@
+/**
+ * Implementation of the Replay class.
+ */
+
+#include "Replay.h"
+
+#include <cmath>
+
+using namespace avc;
+using namespace std;
+
+Replay::Replay(Timon& car) :
+  _car(car),
+  _clock(),
+  _priorClock(0),
+  _ticks(0),
+  _mismatches(0),
+  _truncated(0),
+  _maxDiff(0)
+{
+  _priorClock = Clock::setSource(&_clock);
+}
+
+Replay::~Replay() {
+  Clock::setSource(_priorClock);
+}
+
+void Replay::feed(const SensorTick& tick) {
+  _clock.advanceTo(tick.timeNanos);
+
+  MemoryHeading& gyro = _car.getHeadingSensor();
+  gyro.setResponding(tick.gyroOk != 0);
+  if (tick.gyroOk) {
+    gyro.setData(tick.gyro.data);
+  }
+
+  MemoryVision& vision = _car.getVisionSource();
+  if (!tick.visionOk) {
+    vision.close();
+    return;
+  }
+  vision.open("");
+  int frames = tick.frameCount;
+  if (frames > SensorTick::MAX_FRAMES) {
+    frames = SensorTick::MAX_FRAMES;
+    _truncated++;
+  }
+  for (int i = 0; i < frames; i++) {
+    vision.publish(tick.frames[i]);
+  }
+}
+
+int Replay::run(const vector<SensorTick>& ticks, bool longWay, const AutonPlan* plan,
+                float tolerance, ostream* diffs) {
+  _ticks = _mismatches = _truncated = 0;
+  _maxDiff = 0;
+
+  if (ticks.empty() || (ticks[0].kind != SensorTick::INITIALIZE)) {
+    cerr << "***ERROR*** Recording does not start with the car being initialized\n";
+    return -1;
+  }
+
+  if (plan != 0) {
+    _car.setAuton(*plan, longWay);
+  } else if (longWay) {
+    _car.setAutonLongWay();
+  } else {
+    _car.setAutonShortWay();
+  }
+
+  feed(ticks[0]);
+  _car.initialize();
+
+  const int64_t startNanos = ticks[0].timeNanos;
+  Command::State state = Command::STILL_RUNNING;
+  size_t i;
+
+  for (i = 1; (i < ticks.size()) && (state == Command::STILL_RUNNING); i++) {
+    const SensorTick& tick = ticks[i];
+    feed(tick);
+    state = Command::executeTick(_car);
+    _ticks++;
+
+    float left = _car.getMotor(LEFT_MOTOR).get();
+    float right = _car.getMotor(RIGHT_MOTOR).get();
+    float diff = max(fabs(left - tick.left), fabs(right - tick.right));
+    _maxDiff = max(_maxDiff, diff);
+
+    if ((diff > tolerance) || (state != tick.state)) {
+      _mismatches++;
+      if (diffs != 0) {
+        char path[SensorTick::PATH_LEN];
+        _car.getActivePath(path, sizeof(path));
+        *diffs << "tick " << tick.tick << " (" << ((tick.timeNanos - startNanos) / 1e9)
+               << " secs) recorded " << tick.path << " left=" << tick.left
+               << " right=" << tick.right << " "
+               << Command::stateToString((Command::State) tick.state)
+               << ", replayed " << path << " left=" << left << " right=" << right
+               << " " << Command::stateToString(state) << "\n";
+      }
+    }
+  }
+
+  if (i < ticks.size()) {
+    // Recording kept going after the replayed car stopped
+    _mismatches += ticks.size() - i;
+    if (diffs != 0) {
+      *diffs << "Replay ended at tick " << ticks[i - 1].tick << " but "
+             << (ticks.size() - i) << " more ticks were recorded\n";
+    }
+  }
+
+  _car.end((state == Command::STILL_RUNNING) ? Command::INTERRUPTED : state);
+  return _mismatches;
+}
@@ -0,0 +1,102 @@
+/**
+ * Definition of the Replay class (feeds a sensor recording back
+ * through Timon's control stack).
+ */
+#ifndef __avc_Replay_h
+#define __avc_Replay_h
+
+#include "Timon.h"
+
+#if !AVC_HAL_MEMORY
+#error "Replaying requires the in-memory HAL (make HAL=memory)"
+#endif
+
+#include <iostream>
+#include <vector>
+
+namespace avc {
+
+  /**
+   * Replays the ticks recorded by a SensorRecorder through a car built
+   * with the in-memory HAL and compares the motor power (and command
+   * state) of each tick with what was recorded.
+   *
+   * <p>Each tick sets a virtual clock to the recorded time, hands the
+   * recorded gyro reading and vision frames to the in-memory devices
+   * and then executes the car. Nothing waits, so a minute long run
+   * replays in a few milliseconds and any control change that alters
+   * what the car does shows up as a difference.</p>
+   *
+   * <pre>
+   * vector&lt;SensorTick&gt; ticks;
+   * bool longWay;
+   * AutonPlan plan;
+   * SensorRecorder::load("avc-sensors.bin", ticks, longWay, plan);
+   *
+   * Timon car;
+   * Replay replay(car);
+   * int diffs = replay.run(ticks, longWay, (plan.count != 0) ? &plan : 0, 1e-4, &cout);
+   * </pre>
+   */
+  class Replay {
+
+  public:
+    /**
+     * Switches the current thread to a virtual clock.
+     *
+     * @param car The car to replay through (built with the memory HAL).
+     */
+    Replay(Timon& car);
+
+    /** Switches back to the prior clock. */
+    ~Replay();
+
+    /**
+     * Replays a recorded run.
+     *
+     * @param ticks The recorded ticks (starting with the INITIALIZE tick).
+     * @param longWay Which auton was recorded.
+     * @param plan The compiled plan that was recorded (0 if the built
+     * in auton was run).
+     * @param tolerance Largest difference in motor power that is
+     * still considered a match.
+     * @param diffs Where to describe each tick that differs (0 for
+     * nowhere).
+     *
+     * @return Number of ticks which differ (-1 if the recording can't
+     * be replayed).
+     */
+    int run(const std::vector<SensorTick>& ticks, bool longWay, const AutonPlan* plan,
+            float tolerance, std::ostream* diffs);
+
+    /** Number of ticks executed by the last run. */
+    int getTicks() const { return _ticks; }
+
+    /** Number of ticks which differed on the last run. */
+    int getMismatches() const { return _mismatches; }
+
+    /** Largest difference in motor power seen on the last run. */
+    float getMaxDiff() const { return _maxDiff; }
+
+    /** Number of ticks that read more frames than were recorded. */
+    int getTruncatedTicks() const { return _truncated; }
+
+  private:
+    Replay(const Replay&);
+
+    // Moves time to the tick and hands its readings to the devices
+    void feed(const SensorTick& tick);
+
+    Timon& _car;
+    VirtualClock _clock;
+    ClockSource* _priorClock;
+
+    int _ticks;
+    int _mismatches;
+    int _truncated;
+    float _maxDiff;
+  };
+
+}
+
+#endif
@@ -0,0 +1,132 @@
+/**
+ * Implementation of the SensorRecorder class.
+ */
+
+#include "SensorRecorder.h"
+
+#include <cstdio>
+#include <iostream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+using namespace avc;
+using namespace std;
+
+namespace {
+  // Magic of recordings made before the plan was kept in the header
+  const uint32_t MAGIC_V1 = 0x52534641;
+}
+
+SensorRecorder::SensorRecorder() :
+  _log(0)
+{
+}
+
+SensorRecorder::~SensorRecorder() {
+  close();
+}
+
+bool SensorRecorder::open(const string& path) {
+  close();
+
+  int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (fd < 0) {
+    cerr << "WARNING: Unable to open sensor recording file: " << path << "\n";
+    return false;
+  }
+
+  // Allocate all of the blocks now so a full disk shows up here and
+  // not as a SIGBUS in the middle of a run
+  int err = posix_fallocate(fd, 0, sizeof(SensorLog));
+  if (err != 0) {
+    cerr << "WARNING: Unable to size sensor recording file: " << path << "\n";
+    ::close(fd);
+    return false;
+  }
+
+  void* mem = mmap(0, sizeof(SensorLog), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  ::close(fd);
+
+  if (mem == MAP_FAILED) {
+    cerr << "WARNING: Unable to map sensor recording file: " << path << "\n";
+    return false;
+  }
+
+  _log = static_cast<SensorLog*>(mem);
+  _log->recordSize = sizeof(SensorTick);
+  _log->capacity = SensorLog::CAPACITY;
+  _log->count = 0;
+  _log->longWay = 0;
+  _log->builtIn = 1;
+  _log->plan.clear();
+  __atomic_store_n(&_log->magic, SensorLog::MAGIC, __ATOMIC_RELEASE);
+  return true;
+}
+
+void SensorRecorder::close() {
+  if (_log != 0) {
+    msync(_log, sizeof(SensorLog), MS_ASYNC);
+    munmap(_log, sizeof(SensorLog));
+    _log = 0;
+  }
+}
+
+void SensorRecorder::start(bool longWay, const AutonPlan* plan) {
+  if (_log != 0) {
+    __atomic_store_n(&_log->count, 0, __ATOMIC_RELEASE);
+    _log->longWay = longWay ? 1 : 0;
+    _log->builtIn = (plan == 0) ? 1 : 0;
+    if (plan != 0) {
+      _log->plan = *plan;
+    } else {
+      _log->plan.clear();
+    }
+  }
+}
+
+bool SensorRecorder::load(const string& path, vector<SensorTick>& ticks, bool& longWay,
+                          AutonPlan& plan) {
+  FILE* in = fopen(path.c_str(), "rb");
+  if (in == 0) {
+    cerr << "***ERROR*** Unable to open: " << path << "\n";
+    return false;
+  }
+
+  // Far too big for the stack
+  SensorLog* log = new SensorLog;
+  size_t headerSize = (char*) log->ticks - (char*) log;
+  bool read = (fread(log, headerSize, 1, in) == 1);
+  bool ok = read && (log->magic == SensorLog::MAGIC);
+  if (read && (log->magic == MAGIC_V1)) {
+    cerr << "***ERROR*** Sensor recording is from an older version (doesn't record the plan): "
+         << path << "\n";
+  } else if (!ok) {
+    cerr << "***ERROR*** Not a sensor recording file: " << path << "\n";
+  } else if ((log->recordSize != sizeof(SensorTick)) || (log->count > SensorLog::CAPACITY)) {
+    cerr << "***ERROR*** Record layout (" << log->recordSize
+         << " bytes) does not match this tool (" << sizeof(SensorTick) << " bytes)\n";
+    ok = false;
+  } else if ((log->builtIn == 0) && !log->plan.validate()) {
+    cerr << "***ERROR*** Recorded plan is not valid: " << path << "\n";
+    ok = false;
+  } else {
+    longWay = (log->longWay != 0);
+    if (log->builtIn != 0) {
+      plan.clear();
+    } else {
+      plan = log->plan;
+    }
+    ok = (fread(log->ticks, sizeof(SensorTick), log->count, in) == log->count);
+    if (ok) {
+      ticks.assign(log->ticks, log->ticks + log->count);
+    } else {
+      cerr << "***ERROR*** Sensor recording is truncated: " << path << "\n";
+    }
+  }
+
+  delete log;
+  fclose(in);
+  return ok;
+}
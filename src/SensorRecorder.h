@@ -0,0 +1,175 @@
+/**
+ * Definition of the SensorTick structure and SensorRecorder class
+ * (everything Timon's control loop read and decided, so a run can be
+ * replayed with avc-replay).
+ */
+#ifndef __avc_SensorRecorder_h
+#define __avc_SensorRecorder_h
+
+#include "AutonPlan.h"
+#include "GyroData.h"
+#include "FileData.h"
+
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+
+namespace avc {
+
+  /**
+   * Sensor readings Timon used on a single control loop tick and the
+   * motor power it ended up with.
+   */
+  struct SensorTick {
+    // Most vision frames kept for a tick (the camera is faster than
+    // the control loop, but not by much)
+    static const int MAX_FRAMES = 4;
+
+    // Maximum length of the command path stored (always nul terminated)
+    static const int PATH_LEN = 48;
+
+    enum Kind {
+      // Timon initialized (gyro holds the starting heading)
+      INITIALIZE = 1,
+      // Timon executed
+      EXECUTE = 2
+    };
+
+    // Clock time (nanoseconds) the tick started at
+    int64_t timeNanos;
+    // Tick number within the run (0 for INITIALIZE)
+    uint32_t tick;
+    uint8_t kind;
+    // Set if the gyro reported a heading
+    uint8_t gyroOk;
+    // Set if the vision record was read on this tick (and if it could be)
+    uint8_t visionRead;
+    uint8_t visionOk;
+    // Number of frames read (only the newest MAX_FRAMES are kept)
+    int32_t frameCount;
+    // State Timon returned (EXECUTE)
+    int32_t state;
+    // Power on each motor at the end of the tick
+    float left;
+    float right;
+    GyroSample gyro;
+    VisionFrame frames[MAX_FRAMES];
+    // Active command path at the end of the tick
+    char path[PATH_LEN];
+  };
+
+  /**
+   * Layout of the sensor recording file (a header followed by the
+   * ticks of a single run, oldest first).
+   */
+  struct SensorLog {
+    // Identifies a sensor recording file (changed when the header
+    // layout changes, version 2 added the plan)
+    static const uint32_t MAGIC = 0x32534641;
+
+    // Number of ticks kept (about 13 minutes at 20 Hz)
+    static const uint32_t CAPACITY = 16384;
+
+    uint32_t magic;
+    uint32_t recordSize;
+    uint32_t capacity;
+    // Number of ticks recorded (stops growing once full)
+    uint32_t count;
+    // Set if the long way auton was run (otherwise short)
+    uint8_t longWay;
+    // Set if the built in auton was run (otherwise the steps in plan)
+    uint8_t builtIn;
+    uint8_t reserved[6];
+    // Compiled plan that was run (see Timon::setAuton)
+    AutonPlan plan;
+
+    SensorTick ticks[CAPACITY];
+  };
+
+  /**
+   * Records the readings and decisions of every control loop tick of
+   * a run into a memory mapped file.
+   *
+   * <p>Like the FlightRecorder, adding a tick is just a copy into the
+   * mapped pages (no system calls) and what was added survives the
+   * process crashing. Unlike the FlightRecorder it keeps the start of
+   * the run, as replaying needs everything from the first tick.</p>
+   *
+   * <pre>
+   * SensorRecorder recorder;
+   * recorder.open("avc-sensors.bin");
+   * recorder.start(false, 0);
+   * recorder.add(tick);
+   * </pre>
+   */
+  class SensorRecorder {
+
+  public:
+    SensorRecorder();
+
+    /** Unmaps the file. */
+    ~SensorRecorder();
+
+    /**
+     * Creates (or resets) the recording file and maps it into memory.
+     *
+     * @param path The file to keep the recording in.
+     *
+     * @return true if file was created and mapped.
+     */
+    bool open(const std::string& path);
+
+    /** Schedules a write back of the ticks and unmaps the file. */
+    void close();
+
+    /** Returns true if the file is mapped. */
+    bool isOpen() const { return _log != 0; }
+
+    /**
+     * Throws away any prior ticks to start recording a new run.
+     *
+     * @param longWay Which auton is being run.
+     * @param plan The compiled plan being run (0 for the built in auton).
+     */
+    void start(bool longWay, const AutonPlan* plan);
+
+    /**
+     * Copies a tick into the next slot (ignored once the file is full).
+     */
+    void add(const SensorTick& tick) {
+      if ((_log != 0) && (_log->count < SensorLog::CAPACITY)) {
+        uint32_t count = _log->count;
+        _log->ticks[count] = tick;
+        // Tick must be complete before a reader can see it
+        __atomic_store_n(&_log->count, count + 1, __ATOMIC_RELEASE);
+      }
+    }
+
+    /** Number of ticks recorded in the current run. */
+    uint32_t getCount() const { return (_log != 0) ? _log->count : 0; }
+
+    /**
+     * Reads a recording made by a SensorRecorder.
+     *
+     * @param path The recording file.
+     * @param ticks Where to store the ticks (oldest first).
+     * @param longWay Set to which auton was run.
+     * @param plan Set to the compiled plan that was run (cleared, so
+     * count is 0, if the built in auton was run).
+     *
+     * @return true if the recording was read.
+     */
+    static bool load(const std::string& path, std::vector<SensorTick>& ticks, bool& longWay,
+                     AutonPlan& plan);
+
+  private:
+    SensorRecorder(const SensorRecorder&);
+    SensorRecorder& operator=(const SensorRecorder&);
+
+    SensorLog* _log;
+  };
+
+}
+
+#endif
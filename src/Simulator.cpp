@@ -0,0 +1,377 @@
+/**
+ * Implementation of the Simulator class.
+ */
+
+#include "Simulator.h"
+
+#include <cmath>
+
+using namespace avc;
+using namespace std;
+
+namespace {
+  const double nanosPerSec = 1e9;
+  const double degPerRad = 180.0 / M_PI;
+
+  // Where simulated time starts (any positive value works)
+  const int64_t simStartNanos = 1000 * 1000000000LL;
+
+  // How close (m) the car needs to get to a corner to count as reaching it
+  const double cornerReachedM = 5.0;
+
+  // Corners of the course (in units of the side length) in the order
+  // they are driven (clockwise, starting up the +y axis)
+  const double cornerX[] = { 0, 0, 1, 1 };
+  const double cornerY[] = { 0, 1, 1, 0 };
+
+  // Names of the float values in SimParams
+  struct ParamField {
+    const char* name;
+    float SimParams::* value;
+  };
+
+  const ParamField paramFields[] = {
+    { "maxSpeed", &SimParams::maxSpeed },
+    { "deadband", &SimParams::deadband },
+    { "motorLagSecs", &SimParams::motorLagSecs },
+    { "brakeLagSecs", &SimParams::brakeLagSecs },
+    { "trackWidth", &SimParams::trackWidth },
+    { "turnScrub", &SimParams::turnScrub },
+    { "gyroNoiseDeg", &SimParams::gyroNoiseDeg },
+    { "gyroDriftDegPerSec", &SimParams::gyroDriftDegPerSec },
+    { "cameraLatencySecs", &SimParams::cameraLatencySecs },
+    { "cameraFocalPx", &SimParams::cameraFocalPx },
+    { "cameraHeightM", &SimParams::cameraHeightM },
+    { "cameraRange", &SimParams::cameraRange },
+    { "cameraNoisePx", &SimParams::cameraNoisePx },
+    { "courseSide", &SimParams::courseSide },
+    { "stanchionSpacing", &SimParams::stanchionSpacing },
+    { "stanchionOffset", &SimParams::stanchionOffset },
+    { "stanchionHeight", &SimParams::stanchionHeight },
+    { "stanchionWidth", &SimParams::stanchionWidth }
+  };
+
+  // Moves a wheel speed towards a target with a first order lag
+  double lag(double speed, double target, double dt, double tau) {
+    if (tau <= 0) {
+      return target;
+    }
+    return speed + (target - speed) * (1 - exp(-dt / tau));
+  }
+}
+
+//
+// SimParams methods
+//
+
+SimParams::SimParams() :
+  seed(1),
+  maxSpeed(6.0),
+  deadband(0.04),
+  motorLagSecs(0.15),
+  brakeLagSecs(0.05),
+  trackWidth(0.25),
+  turnScrub(0.3),
+  gyroNoiseDeg(0.1),
+  gyroDriftDegPerSec(0.01),
+  gyroRateHz(100),
+  cameraRateHz(30),
+  cameraLatencySecs(0.03),
+  cameraWidth(320),
+  cameraHeight(240),
+  cameraFocalPx(277),
+  cameraHeightM(0.15),
+  cameraRange(5.0),
+  cameraNoisePx(1.0),
+  courseSide(15.0),
+  stanchionSpacing(3.0),
+  stanchionOffset(1.5),
+  stanchionHeight(0.6),
+  stanchionWidth(0.2),
+  stepNanos(1000000)
+{
+}
+
+bool SimParams::set(const string& name, float value) {
+  for (size_t i = 0; i < sizeof(paramFields) / sizeof(paramFields[0]); i++) {
+    if (name == paramFields[i].name) {
+      this->*paramFields[i].value = value;
+      return true;
+    }
+  }
+  return false;
+}
+
+//
+// Simulator methods
+//
+
+Simulator::Simulator(Timon& car, const SimParams& params) :
+  _car(car),
+  _params(params),
+  _random(params.seed),
+  _normal(0, 1),
+  _stanchions(),
+  _startNanos(0),
+  _nowNanos(0),
+  _nextGyroNanos(0),
+  _nextFrameNanos(0),
+  _clock(simStartNanos),
+  _priorClock(0),
+  _pending(),
+  _x(0),
+  _y(0),
+  _theta(0),
+  _leftSpeed(0),
+  _rightSpeed(0),
+  _gyroOffset(0),
+  _distance(0),
+  _maxOffLine(0),
+  _corners(0),
+  _collisions(0)
+{
+  _endPath[0] = '\0';
+  _priorClock = Clock::setSource(&_clock);
+  _nowNanos = simStartNanos;
+  buildCourse();
+  reset();
+}
+
+Simulator::~Simulator() {
+  Clock::setSource(_priorClock);
+}
+
+void Simulator::buildCourse() {
+  const double side = _params.courseSide;
+  _stanchions.clear();
+
+  for (int i = 0; i < 4; i++) {
+    int next = (i + 1) % 4;
+    double dx = cornerX[next] - cornerX[i];
+    double dy = cornerY[next] - cornerY[i];
+    // Right hand side of the driving line (inside of the course)
+    double nx = dy;
+    double ny = -dx;
+    double offset = _params.stanchionOffset;
+
+    for (double s = _params.stanchionSpacing; s < side - _params.stanchionSpacing / 2;
+         s += _params.stanchionSpacing) {
+      Stanchion red = { cornerX[i] * side + dx * s + nx * offset,
+                        cornerY[i] * side + dy * s + ny * offset, Found::Red, false };
+      _stanchions.push_back(red);
+    }
+
+    // Yellow marks where to turn
+    Stanchion yellow = { cornerX[next] * side + nx * offset,
+                         cornerY[next] * side + ny * offset, Found::Yellow, false };
+    _stanchions.push_back(yellow);
+  }
+}
+
+void Simulator::reset() {
+  _random.seed(_params.seed);
+  _normal.reset();
+
+  _startNanos = _nowNanos;
+  _nextGyroNanos = _nowNanos;
+  _nextFrameNanos = _nowNanos;
+  _pending.clear();
+
+  _x = _y = _theta = 0;
+  _leftSpeed = _rightSpeed = 0;
+  _distance = _maxOffLine = 0;
+  _corners = _collisions = 0;
+  for (size_t i = 0; i < _stanchions.size(); i++) {
+    _stanchions[i].hit = false;
+  }
+
+  // Gyro reports headings relative to wherever it was reset
+  _gyroOffset = uniform_real_distribution<double>(0, 360)(_random);
+
+  _car.getMotor(LEFT_MOTOR).disable();
+  _car.getMotor(RIGHT_MOTOR).disable();
+  sampleGyro();
+}
+
+double Simulator::getHeading() const {
+  double heading = fmod(_theta * degPerRad, 360.0);
+  return (heading < 0) ? heading + 360.0 : heading;
+}
+
+void Simulator::advance(int64_t nanos) {
+  // Catch up with any time the car slept through (Timer::sleep)
+  const int64_t end = max(_nowNanos + nanos, _clock.nowNanos());
+  const int64_t gyroPeriod = (int64_t) (nanosPerSec / max(1, _params.gyroRateHz));
+  const int64_t framePeriod = (int64_t) (nanosPerSec / max(1, _params.cameraRateHz));
+  const int64_t latency = (int64_t) (_params.cameraLatencySecs * nanosPerSec);
+  MemoryVision& vision = _car.getVisionSource();
+
+  while (_nowNanos < end) {
+    int64_t step = min(_params.stepNanos, end - _nowNanos);
+    stepPhysics(step / nanosPerSec);
+    _nowNanos += step;
+    _clock.advanceTo(_nowNanos);
+
+    if (_nowNanos >= _nextGyroNanos) {
+      sampleGyro();
+      _nextGyroNanos += gyroPeriod;
+    }
+    if (_nowNanos >= _nextFrameNanos) {
+      captureFrame();
+      _nextFrameNanos += framePeriod;
+    }
+    while (!_pending.empty() && (_pending.front().timeNanos + latency <= _nowNanos)) {
+      vision.publish(_pending.front().data, _pending.front().timeNanos);
+      _pending.pop_front();
+    }
+
+    trackProgress();
+  }
+}
+
+Command::State Simulator::run(Command& command, int rateHz, float maxSecs) {
+  const int64_t period = (int64_t) (nanosPerSec / max(1, rateHz));
+  const int64_t stopAt = _nowNanos + (int64_t) (maxSecs * nanosPerSec);
+
+  _endPath[0] = '\0';
+  command.initialize();
+
+  Command::State state;
+  while ((state = Command::executeTick(command)) == Command::STILL_RUNNING) {
+    if (_nowNanos >= stopAt) {
+      state = Command::TIMED_OUT;
+      break;
+    }
+    advance(period);
+  }
+  command.getActivePath(_endPath, sizeof(_endPath));
+  command.end(state);
+  return state;
+}
+
+void Simulator::stepPhysics(double dt) {
+  MemoryMotor& leftMotor = _car.getMotor(LEFT_MOTOR);
+  MemoryMotor& rightMotor = _car.getMotor(RIGHT_MOTOR);
+
+  // NOTE: Motors are wired crossed and reversed (see Timon::drive)
+  const MemoryMotor* wheels[] = { &rightMotor, &leftMotor };
+  double* speeds[] = { &_leftSpeed, &_rightSpeed };
+
+  for (int i = 0; i < 2; i++) {
+    const MemoryMotor& motor = *wheels[i];
+    double power = -motor.get();
+    double target = (fabs(power) < _params.deadband) ? 0 : power * _params.maxSpeed;
+    double tau = _params.motorLagSecs;
+    if (motor.isBraking()) {
+      target = 0;
+      tau = _params.brakeLagSecs;
+    }
+    *speeds[i] = lag(*speeds[i], target, dt, tau);
+  }
+
+  double speed = (_leftSpeed + _rightSpeed) / 2;
+  double turnRate = _params.turnScrub * (_leftSpeed - _rightSpeed) / _params.trackWidth;
+
+  // Integrate using the heading at the middle of the step
+  double theta = _theta + turnRate * dt / 2;
+  _x += speed * sin(theta) * dt;
+  _y += speed * cos(theta) * dt;
+  _theta += turnRate * dt;
+  _distance += fabs(speed) * dt;
+}
+
+void Simulator::sampleGyro() {
+  double secs = (_nowNanos - _startNanos) / nanosPerSec;
+  double heading = _theta * degPerRad + _gyroOffset + _params.gyroDriftDegPerSec * secs
+    + _params.gyroNoiseDeg * _normal(_random);
+
+  // BNO055 reports headings in 1/16 degree steps
+  _car.getHeadingSensor().setHeading(floor(heading * 16 + 0.5) / 16);
+}
+
+void Simulator::captureFrame() {
+  const double sinT = sin(_theta);
+  const double cosT = cos(_theta);
+  const double focal = _params.cameraFocalPx;
+
+  const Stanchion* best = 0;
+  double bestAhead = 0;
+  double bestRight = 0;
+
+  for (size_t i = 0; i < _stanchions.size(); i++) {
+    const Stanchion& s = _stanchions[i];
+    double dx = s.x - _x;
+    double dy = s.y - _y;
+    double ahead = dx * sinT + dy * cosT;
+    double right = dx * cosT - dy * sinT;
+
+    if ((ahead < 0.2) || (ahead > _params.cameraRange)) {
+      continue;
+    }
+    double xMid = _params.cameraWidth / 2 + focal * right / ahead;
+    if ((xMid < 0) || (xMid >= _params.cameraWidth)) {
+      continue;
+    }
+    // Detector reports the largest (closest) blob
+    if ((best == 0) || (ahead < bestAhead)) {
+      best = &s;
+      bestAhead = ahead;
+      bestRight = right;
+    }
+  }
+
+  VisionFrame frame;
+  frame.timeNanos = _nowNanos;
+  if (best != 0) {
+    FileData& data = frame.data;
+    double height = focal * _params.stanchionHeight / bestAhead
+      + _params.cameraNoisePx * _normal(_random);
+    data.found = best->color;
+    data.boxHeight = (int) (max(1.0, height) + 0.5);
+    data.boxWidth = (int) (focal * _params.stanchionWidth / bestAhead + 0.5);
+    data.xMid = (int) (_params.cameraWidth / 2 + focal * bestRight / bestAhead);
+    data.yBot = min(_params.cameraHeight - 1,
+                    (int) (_params.cameraHeight / 2 + focal * _params.cameraHeightM / bestAhead));
+  }
+  _pending.push_back(frame);
+}
+
+void Simulator::trackProgress() {
+  const double side = _params.courseSide;
+  int from = _corners % 4;
+  int to = (from + 1) % 4;
+
+  double cx = cornerX[to] * side;
+  double cy = cornerY[to] * side;
+  if (hypot(cx - _x, cy - _y) < cornerReachedM) {
+    _corners++;
+  }
+
+  // Distance from the line between the corners we are driving between
+  // (ignoring the corners where the car is expected to cut across)
+  double dx = cornerX[to] - cornerX[from];
+  double dy = cornerY[to] - cornerY[from];
+  double relX = _x - cornerX[from] * side;
+  double relY = _y - cornerY[from] * side;
+  double along = relX * dx + relY * dy;
+  if ((along > cornerReachedM) && (along < side - cornerReachedM)) {
+    _maxOffLine = max(_maxOffLine, fabs(relX * dy - relY * dx));
+  }
+
+  const double hitDist = (_params.trackWidth + _params.stanchionWidth) / 2;
+  for (size_t i = 0; i < _stanchions.size(); i++) {
+    Stanchion& s = _stanchions[i];
+    if (!s.hit && (hypot(s.x - _x, s.y - _y) < hitDist)) {
+      s.hit = true;
+      _collisions++;
+    }
+  }
+}
+
+ostream& Simulator::print(ostream& out) const {
+  out << "Simulator(secs=" << getSecs() << ", x=" << _x << ", y=" << _y
+      << ", heading=" << getHeading() << ", distance=" << _distance
+      << ", corners=" << _corners << ", maxOffLine=" << _maxOffLine
+      << ", collisions=" << _collisions << ")";
+  return out;
+}
@@ -0,0 +1,250 @@
+/**
+ * Definition of the Simulator class (drives Timon's in-memory HAL
+ * devices with a simulated car and course).
+ */
+#ifndef __avc_Simulator_h
+#define __avc_Simulator_h
+
+#include "Timon.h"
+
+#if !AVC_HAL_MEMORY
+#error "The simulator requires the in-memory HAL (make HAL=memory)"
+#endif
+
+#include <deque>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+
+namespace avc {
+
+  /**
+   * Physical constants of the simulated car, sensors and course (the
+   * defaults are rough measurements of Timon and the AVC course).
+   */
+  struct SimParams {
+    // Seed for the sensor noise (and initial gyro offset)
+    uint32_t seed;
+
+    // Ground speed (m/s) of a wheel at full power
+    float maxSpeed;
+    // Power below which a wheel does not move (static friction)
+    float deadband;
+    // Time constant (seconds) of a wheel reaching a new speed
+    float motorLagSecs;
+    // Time constant (seconds) of a wheel stopping while braking
+    float brakeLagSecs;
+    // Distance (m) between the left and right wheels
+    float trackWidth;
+    // Fraction of the wheel speed difference that turns the car
+    // (skid steering scrubs off the rest)
+    float turnScrub;
+
+    // Standard deviation (degrees) of the heading reported
+    float gyroNoiseDeg;
+    // How fast (degrees/sec) the reported heading drifts
+    float gyroDriftDegPerSec;
+    // How often the gyro reports a new heading
+    int gyroRateHz;
+
+    // How often the camera captures a frame
+    int cameraRateHz;
+    // Time (seconds) from capture until avc-vision publishes the frame
+    float cameraLatencySecs;
+    // Image size (pixels) and focal length (pixels)
+    int cameraWidth;
+    int cameraHeight;
+    float cameraFocalPx;
+    // Height (m) of the camera above the ground
+    float cameraHeightM;
+    // Stanchions further away than this (m) are too small to detect
+    float cameraRange;
+    // Standard deviation (pixels) of the detected box height
+    float cameraNoisePx;
+
+    // Length (m) of each side of the (square, clockwise) course
+    float courseSide;
+    // Distance (m) between red stanchions along a side
+    float stanchionSpacing;
+    // How far (m) the stanchions are to the right of the driving line
+    float stanchionOffset;
+    // Size (m) of a stanchion
+    float stanchionHeight;
+    float stanchionWidth;
+
+    // Length of each physics step (nanoseconds)
+    int64_t stepNanos;
+
+    /** Fills in the default values. */
+    SimParams();
+
+    /**
+     * Changes one of the float values by name (like "maxSpeed").
+     *
+     * @return false if there is no float value with that name.
+     */
+    bool set(const std::string& name, float value);
+  };
+
+  /**
+   * Faster than real time simulation of Timon on the AVC course.
+   *
+   * <p>Each physics step applies the power levels Timon set on its
+   * motors (with motor lag) to a differential drive model of the
+   * car. The gyro is fed a noisy heading and a synthetic camera fills
+   * in the FileData records avc-vision would publish. Time is
+   * virtual (see VirtualClock), so the control loop runs as fast as
+   * the CPU allows.</p>
+   *
+   * <pre>
+   * Timon car;
+   * Simulator sim(car);
+   * car.setAutonShortWay();
+   * Command::State state = sim.run(car, 20, 120.0);
+   * sim.print(cout) << "\n";
+   * </pre>
+   */
+  class Simulator {
+
+  public:
+    /**
+     * Switches the current thread to a virtual clock and places the
+     * car at the start of the course.
+     *
+     * @param car The car to simulate (built with the memory HAL).
+     * @param params The physical constants to use.
+     */
+    Simulator(Timon& car, const SimParams& params = SimParams());
+
+    /** Switches back to the prior clock. */
+    ~Simulator();
+
+    /**
+     * Puts the car back at the start of the course (stopped and
+     * facing down the first side).
+     */
+    void reset();
+
+    /**
+     * Runs the physics and sensors forward.
+     *
+     * @param nanos How far to move simulated time forward.
+     */
+    void advance(int64_t nanos);
+
+    /**
+     * Runs a command until it ends (executing it at a fixed rate with
+     * the physics advanced between each execution).
+     *
+     * @param command The command to run (typically the car itself).
+     * @param rateHz How many times per simulated second to execute it.
+     * @param maxSecs Stop (TIMED_OUT) after this many simulated seconds.
+     *
+     * @return The reason the command ended.
+     */
+    Command::State run(Command& command, int rateHz, float maxSecs);
+
+    /** Simulated seconds since the last reset. */
+    double getSecs() const { return (_nowNanos - _startNanos) / 1e9; }
+
+    /** Position (m) of the car (start is 0, 0 and +y is the first side). */
+    double getX() const { return _x; }
+    double getY() const { return _y; }
+
+    /** True heading (degrees clockwise from the first side). */
+    double getHeading() const;
+
+    /** Total distance (m) the car has traveled. */
+    double getDistance() const { return _distance; }
+
+    /** Number of corners of the course the car has reached. */
+    int getCornersReached() const { return _corners; }
+
+    /** Farthest (m) the car has strayed from the driving line. */
+    double getMaxOffLine() const { return _maxOffLine; }
+
+    /** Number of times the car ran into a stanchion. */
+    int getCollisions() const { return _collisions; }
+
+    /**
+     * Path of the command that was active when the last run ended
+     * (empty if it ran to completion).
+     */
+    const char* getEndPath() const { return _endPath; }
+
+    /** Dumps the state of the simulated car. */
+    std::ostream& print(std::ostream& out) const;
+
+  private:
+    Simulator(const Simulator&);
+
+    struct Stanchion {
+      double x;
+      double y;
+      Found color;
+      bool hit;
+    };
+
+    // Places the stanchions around the course
+    void buildCourse();
+
+    // Moves the car forward one physics step
+    void stepPhysics(double dt);
+
+    // Reports a new heading to the gyro
+    void sampleGyro();
+
+    // Captures a frame with the synthetic camera
+    void captureFrame();
+
+    // Updates corners reached, distance from line and collisions
+    void trackProgress();
+
+    Timon& _car;
+    SimParams _params;
+    std::mt19937 _random;
+    std::normal_distribution<float> _normal;
+
+    std::vector<Stanchion> _stanchions;
+
+    // Simulated time
+    int64_t _startNanos;
+    int64_t _nowNanos;
+    int64_t _nextGyroNanos;
+    int64_t _nextFrameNanos;
+
+    // Virtual time seen by the car (and the clock it replaced)
+    VirtualClock _clock;
+    ClockSource* _priorClock;
+
+    // Frames captured but not yet published
+    std::deque<VisionFrame> _pending;
+
+    // State of the car (heading in radians)
+    double _x;
+    double _y;
+    double _theta;
+    double _leftSpeed;
+    double _rightSpeed;
+    double _gyroOffset;
+
+    // Progress around the course
+    double _distance;
+    double _maxOffLine;
+    int _corners;
+    int _collisions;
+
+    // Active command when run() stopped
+    char _endPath[64];
+  };
+
+  inline std::ostream& operator<<(std::ostream& out, const Simulator& sim) {
+    return sim.print(out);
+  }
+
+}
+
+#endif
@@ -0,0 +1,146 @@
+/**
+ * Implementation of the StanchionDetector class.
+ */
+
+#include "StanchionDetector.h"
+
+#include <algorithm>
+
+using namespace avc;
+using namespace std;
+
+namespace {
+  // Marks a sampled pixel as already assigned to a blob
+  const uint8_t visitedBit = 0x80;
+
+  // Computes hue in degrees [0, 360)
+  inline int hueDegrees(int r, int g, int b, int maxC, int delta) {
+    int h;
+    if (maxC == r) {
+      h = (60 * (g - b)) / delta;
+    } else if (maxC == g) {
+      h = 120 + (60 * (b - r)) / delta;
+    } else {
+      h = 240 + (60 * (r - g)) / delta;
+    }
+    return (h < 0) ? h + 360 : h;
+  }
+}
+
+StanchionDetector::StanchionDetector(const Config& config) :
+  _config(config),
+  _colors(),
+  _stack()
+{
+  if (_config.step < 1) {
+    _config.step = 1;
+  }
+}
+
+Found StanchionDetector::classify(const uint8_t* rgb) const {
+  int r = rgb[0];
+  int g = rgb[1];
+  int b = rgb[2];
+  int maxC = max(r, max(g, b));
+  int minC = min(r, min(g, b));
+  int delta = maxC - minC;
+
+  if ((maxC < _config.minValue) || (delta == 0) ||
+      ((delta * 255) < (_config.minSaturation * maxC))) {
+    return Found::None;
+  }
+
+  int h = hueDegrees(r, g, b, maxC, delta);
+  if ((h >= _config.redHueMin) || (h <= _config.redHueMax)) {
+    return Found::Red;
+  }
+  if ((h >= _config.yellowHueMin) && (h <= _config.yellowHueMax)) {
+    return Found::Yellow;
+  }
+  return Found::None;
+}
+
+bool StanchionDetector::detect(const Image& img, FileData& result) {
+  const int step = _config.step;
+  const int w = img.width / step;
+  const int h = img.height / step;
+
+  result.found = Found::None;
+  result.boxWidth = result.boxHeight = result.xMid = result.yBot = 0;
+
+  if ((w < 1) || (h < 1)) {
+    return false;
+  }
+
+  // Classify sampled pixels
+  _colors.resize((size_t) w * h);
+  for (int y = 0; y < h; y++) {
+    uint8_t* row = &_colors[(size_t) y * w];
+    for (int x = 0; x < w; x++) {
+      row[x] = (uint8_t) classify(img.pixel(x * step, y * step));
+    }
+  }
+
+  // Flood fill to find the largest blob of a single color
+  int bestArea = 0;
+  int bestMinX = 0, bestMaxX = 0, bestMinY = 0, bestMaxY = 0;
+  Found bestColor = Found::None;
+
+  for (int start = 0; start < w * h; start++) {
+    uint8_t color = _colors[start];
+    if ((color == Found::None) || (color & visitedBit)) {
+      continue;
+    }
+
+    int area = 0;
+    int minX = w, maxX = -1, minY = h, maxY = -1;
+
+    _stack.clear();
+    _stack.push_back(start);
+    _colors[start] |= visitedBit;
+
+    while (!_stack.empty()) {
+      int idx = _stack.back();
+      _stack.pop_back();
+
+      int x = idx % w;
+      int y = idx / w;
+      area++;
+      minX = min(minX, x);
+      maxX = max(maxX, x);
+      minY = min(minY, y);
+      maxY = max(maxY, y);
+
+      // 4 connected neighbors of the same color
+      int neighbors[4] = { idx - 1, idx + 1, idx - w, idx + w };
+      bool valid[4] = { x > 0, x < w - 1, y > 0, y < h - 1 };
+      for (int i = 0; i < 4; i++) {
+        if (valid[i] && (_colors[neighbors[i]] == color)) {
+          _colors[neighbors[i]] |= visitedBit;
+          _stack.push_back(neighbors[i]);
+        }
+      }
+    }
+
+    if (area > bestArea) {
+      bestArea = area;
+      bestColor = (Found) color;
+      bestMinX = minX;
+      bestMaxX = maxX;
+      bestMinY = minY;
+      bestMaxY = maxY;
+    }
+  }
+
+  if (bestArea < _config.minArea) {
+    return false;
+  }
+
+  // Report in full resolution coordinates
+  result.found = bestColor;
+  result.boxWidth = (bestMaxX - bestMinX + 1) * step;
+  result.boxHeight = (bestMaxY - bestMinY + 1) * step;
+  result.xMid = ((bestMinX + bestMaxX) * step) / 2;
+  result.yBot = bestMaxY * step + step - 1;
+  return true;
+}
@@ -0,0 +1,83 @@
+/**
+ * Definition of the StanchionDetector class.
+ */
+#ifndef __avc_StanchionDetector_h
+#define __avc_StanchionDetector_h
+
+#include "FileData.h"
+#include "FrameSource.h"
+
+#include <vector>
+
+namespace avc {
+
+  /**
+   * Finds the largest red or yellow stanchion in a camera frame.
+   *
+   * <p>Pixels are classified by hue, saturation and brightness (on a
+   * sub-sampled grid), neighboring pixels of the same color are
+   * grouped into blobs and the bounding box of the largest blob is
+   * reported.</p>
+   */
+  class StanchionDetector {
+
+  public:
+    /**
+     * Tuning values for the detector.
+     */
+    struct Config {
+      // Hue range (degrees) considered red (wraps around 0)
+      int redHueMin;
+      int redHueMax;
+      // Hue range (degrees) considered yellow
+      int yellowHueMin;
+      int yellowHueMax;
+      // Minimum saturation [0, 255] for a pixel to have a color
+      int minSaturation;
+      // Minimum brightness [0, 255] for a pixel to have a color
+      int minValue;
+      // Minimum number of (sampled) pixels in a blob
+      int minArea;
+      // Only look at every Nth pixel in each direction
+      int step;
+
+      Config() :
+        redHueMin(340), redHueMax(15),
+        yellowHueMin(40), yellowHueMax(70),
+        minSaturation(110), minValue(70),
+        minArea(12), step(2) {
+      }
+    };
+
+    StanchionDetector(const Config& config = Config());
+
+    /**
+     * Looks for a stanchion in a frame.
+     *
+     * @param img The frame to process.
+     *
+     * @param result Where to store the results (found, boxWidth,
+     * boxHeight, xMid and yBot are set - in full resolution pixels).
+     *
+     * @return true if a stanchion was found.
+     */
+    bool detect(const Image& img, FileData& result);
+
+    /**
+     * Classifies a single pixel.
+     *
+     * @return Found::Red, Found::Yellow or Found::None.
+     */
+    Found classify(const uint8_t* rgb) const;
+
+  private:
+    Config _config;
+
+    // Working buffers (reused between frames)
+    std::vector<uint8_t> _colors;
+    std::vector<int> _stack;
+  };
+
+}
+
+#endif
@@ -0,0 +1,88 @@
+/**
+ * Implementation of the SysfsFile class.
+ */
+
+#include "SysfsFile.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+
+using namespace avc;
+using namespace std;
+
+namespace {
+  int64_t nowNanos() {
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000000000LL + now.tv_nsec;
+  }
+}
+
+SysfsFile::SysfsFile() :
+  _fd(-1),
+  _path(),
+  _writes(0),
+  _failures(0),
+  _totalNanos(0),
+  _maxNanos(0)
+{
+}
+
+SysfsFile::~SysfsFile() {
+  close();
+}
+
+bool SysfsFile::open(const string& path) {
+  close();
+  _path = path;
+  _fd = ::open(path.c_str(), O_WRONLY | O_CLOEXEC);
+  return _fd >= 0;
+}
+
+void SysfsFile::close() {
+  if (_fd >= 0) {
+    ::close(_fd);
+    _fd = -1;
+  }
+}
+
+bool SysfsFile::write(const char* value, size_t len) {
+  if (_fd < 0) {
+    return false;
+  }
+
+  int64_t start = nowNanos();
+  ssize_t n;
+  do {
+    // sysfs attributes are always replaced from the start of the file
+    n = pwrite(_fd, value, len, 0);
+  } while ((n < 0) && (errno == EINTR));
+  int64_t elapsed = nowNanos() - start;
+
+  _writes++;
+  _totalNanos += elapsed;
+  if (elapsed > _maxNanos) {
+    _maxNanos = elapsed;
+  }
+
+  bool ok = (n == (ssize_t) len);
+  if (!ok) {
+    _failures++;
+  }
+  return ok;
+}
+
+void SysfsFile::clearStats() {
+  _writes = _failures = 0;
+  _totalNanos = _maxNanos = 0;
+}
+
+ostream& SysfsFile::printStats(ostream& out) const {
+  out << _path << ": " << _writes << " writes ("
+      << _failures << " failed, avg "
+      << (getAvgNanos() / 1000.0) << " usecs, max "
+      << (_maxNanos / 1000.0) << " usecs)";
+  return out;
+}
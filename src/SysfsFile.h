@@ -0,0 +1,109 @@
+/**
+ * Definition of the SysfsFile class.
+ */
+#ifndef __avc_SysfsFile_h
+#define __avc_SysfsFile_h
+
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include <stdint.h>
+
+namespace avc {
+
+  /**
+   * Keeps a sysfs attribute file (like a GPIO "value" or PWM "duty"
+   * file) open so values can be written without the cost of opening,
+   * formatting and closing a stream on every update.
+   *
+   * <p>Every write is timed so we can see what each update to the
+   * hardware really costs.</p>
+   *
+   * <pre>
+   * SysfsFile value;
+   * if (value.open("/sys/class/gpio/gpio5/value")) {
+   *   value.write("1\n", 2);
+   * }
+   * value.printStats(cout) << "\n";
+   * </pre>
+   */
+  class SysfsFile {
+
+  public:
+    SysfsFile();
+
+    /** Closes the file (if open). */
+    ~SysfsFile();
+
+    /**
+     * Opens the attribute file for writing (closing any prior file).
+     *
+     * @param path Full path to the sysfs attribute.
+     *
+     * @return true if opened.
+     */
+    bool open(const std::string& path);
+
+    /** Closes the file (if open). */
+    void close();
+
+    /** Returns true if the file is open. */
+    bool isOpen() const { return _fd >= 0; }
+
+    /** Path of the file last opened. */
+    const std::string& getPath() const { return _path; }
+
+    /**
+     * Replaces the value of the attribute (written as a single write
+     * at the start of the file as sysfs expects).
+     *
+     * @param value The characters to write.
+     * @param len Number of characters to write.
+     *
+     * @return true if entire value was accepted.
+     */
+    bool write(const char* value, size_t len);
+
+    /** Writes a nul terminated value. */
+    bool write(const char* value) {
+      return write(value, strlen(value));
+    }
+
+    /** Number of writes made. */
+    uint32_t getWrites() const { return _writes; }
+
+    /** Number of writes that failed. */
+    uint32_t getFailures() const { return _failures; }
+
+    /** Longest time (nanoseconds) a single write took. */
+    int64_t getMaxNanos() const { return _maxNanos; }
+
+    /** Average time (nanoseconds) of a write (0 if no writes). */
+    int64_t getAvgNanos() const {
+      return (_writes > 0) ? (_totalNanos / _writes) : 0;
+    }
+
+    /** Clears the write statistics. */
+    void clearStats();
+
+    /**
+     * Prints write statistics (counts and times in microseconds).
+     */
+    std::ostream& printStats(std::ostream& out) const;
+
+  private:
+    SysfsFile(const SysfsFile&);
+    SysfsFile& operator=(const SysfsFile&);
+
+    int _fd;
+    std::string _path;
+    uint32_t _writes;
+    uint32_t _failures;
+    int64_t _totalNanos;
+    int64_t _maxNanos;
+  };
+
+}
+
+#endif
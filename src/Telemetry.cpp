@@ -0,0 +1,216 @@
+/**
+ * Implementation of the TelemetryRecord structure and TelemetryLog class.
+ */
+
+#include "Telemetry.h"
+#include "Clock.h"
+
+#include <system_error>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+
+using namespace avc;
+using namespace std;
+
+namespace {
+  // How long the flush thread sleeps between writes (and when idle)
+  const long flushPeriodNanos = 50000000;
+  const long idlePeriodNanos = 250000000;
+
+  const char* noLabels[] = { 0 };
+  const char* driveToTurnLabels[] = { "turned", "powerCorrect", 0 };
+  const char* makeTurnLabels[] = { "turned", "err", "steer", 0 };
+  const char* makeSmoothTurnLabels[] = { "turned", 0 };
+  const char* driveStraightLabels[] = {
+    "desiredHeading", "heading", "angErr", "left", "right",
+    "redCnt", "yelCnt", "correction", 0
+  };
+
+  const char* const* kindLabels[TelemetryRecord::NUM_KINDS] = {
+    noLabels, driveToTurnLabels, makeTurnLabels, makeSmoothTurnLabels,
+    driveStraightLabels
+  };
+
+  // Writes entire buffer (retrying on partial writes)
+  bool writeAll(int fd, const void* data, size_t len) {
+    const char* buf = static_cast<const char*>(data);
+    while (len > 0) {
+      ssize_t n = ::write(fd, buf, len);
+      if (n < 0) {
+	if (errno == EINTR) {
+	  continue;
+	}
+	return false;
+      }
+      buf += n;
+      len -= n;
+    }
+    return true;
+  }
+}
+
+//
+// TelemetryRecord methods
+//
+
+const char* const* TelemetryRecord::getLabels(int kind) {
+  return ((unsigned) kind < NUM_KINDS) ? kindLabels[kind] : noLabels;
+}
+
+ostream& TelemetryRecord::print(ostream& out) const {
+  char name[NAME_LEN + 1];
+  memcpy(name, command, NAME_LEN);
+  name[NAME_LEN] = '\0';
+
+  out << (timeNanos / 1000000) << " " << name << "(elapsed=" << elapsed
+      << ")  Timon(left=" << left << ", right=" << right << ", heading=" << heading
+      << ", frameCount=" << frameCount << ", found=" << found
+      << ", box_height=" << boxHeight << ", inTurn=" << (int) inTurn << ")";
+
+  const char* const* label = getLabels(kind);
+  for (int i = 0; (i < numValues) && (i < MAX_VALUES); i++) {
+    const char* valueName = (*label != 0) ? *label++ : "value";
+    out << "  " << valueName << ": " << values[i];
+  }
+  return out;
+}
+
+//
+// TelemetryLog methods
+//
+
+TelemetryLog::TelemetryLog() :
+  _fd(-1),
+  _flusher(),
+  _running(false),
+  _ring(new TelemetryRecord[CAPACITY]),
+  _head(0),
+  _tail(0),
+  _seq(0),
+  _dropped(0),
+  _written(0)
+{
+}
+
+TelemetryLog::~TelemetryLog() {
+  close();
+  delete[] _ring;
+}
+
+bool TelemetryLog::open(const string& path) {
+  close();
+
+  _fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (_fd < 0) {
+    cerr << "WARNING: Unable to open telemetry file: " << path << "\n";
+    return false;
+  }
+
+  Header header;
+  header.magic = MAGIC;
+  header.recordSize = sizeof(TelemetryRecord);
+  if (!writeAll(_fd, &header, sizeof(header))) {
+    cerr << "WARNING: Unable to write to telemetry file: " << path << "\n";
+    ::close(_fd);
+    _fd = -1;
+    return false;
+  }
+
+  __atomic_store_n(&_running, true, __ATOMIC_RELEASE);
+  try {
+    _flusher = thread(&TelemetryLog::run, this);
+  } catch (const system_error& e) {
+    cerr << "***ERROR*** Unable to start telemetry thread: " << e.what() << "\n";
+    __atomic_store_n(&_running, false, __ATOMIC_RELEASE);
+    ::close(_fd);
+    _fd = -1;
+    return false;
+  }
+  return true;
+}
+
+void TelemetryLog::close() {
+  __atomic_store_n(&_running, false, __ATOMIC_RELEASE);
+  if (_flusher.joinable()) {
+    _flusher.join();
+  }
+  if (_fd >= 0) {
+    ::close(_fd);
+    _fd = -1;
+  }
+}
+
+bool TelemetryLog::add(const TelemetryRecord& rec) {
+  if (_fd < 0) {
+    return false;
+  }
+
+  uint32_t head = _head;
+  uint32_t tail = __atomic_load_n(&_tail, __ATOMIC_ACQUIRE);
+  if ((head - tail) >= CAPACITY) {
+    __atomic_store_n(&_dropped, _dropped + 1, __ATOMIC_RELAXED);
+    return false;
+  }
+
+  TelemetryRecord& slot = _ring[head & (CAPACITY - 1)];
+  slot = rec;
+  slot.seq = _seq++;
+  __atomic_store_n(&_head, head + 1, __ATOMIC_RELEASE);
+  return true;
+}
+
+int64_t TelemetryLog::nowNanos() {
+  return Clock::nowNanos();
+}
+
+uint32_t TelemetryLog::getDropped() const {
+  return __atomic_load_n(&_dropped, __ATOMIC_RELAXED);
+}
+
+uint32_t TelemetryLog::getWritten() const {
+  return __atomic_load_n(&_written, __ATOMIC_RELAXED);
+}
+
+int TelemetryLog::flush() {
+  uint32_t tail = _tail;
+  uint32_t head = __atomic_load_n(&_head, __ATOMIC_ACQUIRE);
+  int flushed = 0;
+
+  while (tail != head) {
+    // Write contiguous run of slots (up to the end of the ring)
+    uint32_t idx = tail & (CAPACITY - 1);
+    uint32_t n = head - tail;
+    if (idx + n > CAPACITY) {
+      n = CAPACITY - idx;
+    }
+
+    if (!writeAll(_fd, &_ring[idx], n * sizeof(TelemetryRecord))) {
+      // Nothing we can do, discard so control loop is not blocked
+      cerr << "WARNING: Failed to write telemetry records\n";
+    } else {
+      __atomic_store_n(&_written, _written + n, __ATOMIC_RELAXED);
+    }
+
+    tail += n;
+    __atomic_store_n(&_tail, tail, __ATOMIC_RELEASE);
+    flushed += n;
+  }
+  return flushed;
+}
+
+void TelemetryLog::run() {
+  timespec period;
+  period.tv_sec = 0;
+  period.tv_nsec = idlePeriodNanos;
+
+  while (__atomic_load_n(&_running, __ATOMIC_ACQUIRE)) {
+    nanosleep(&period, 0);
+    // Back off while nothing is being logged
+    period.tv_nsec = (flush() > 0) ? flushPeriodNanos : idlePeriodNanos;
+  }
+  // Pick up anything added before we were stopped
+  flush();
+}
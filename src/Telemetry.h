@@ -0,0 +1,190 @@
+/**
+ * Definition of the TelemetryRecord structure and TelemetryLog class.
+ */
+#ifndef __avc_Telemetry_h
+#define __avc_Telemetry_h
+
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include <stdint.h>
+
+namespace avc {
+
+  /**
+   * Fixed size binary record of the state of the car logged on each
+   * tick of a command (decoded offline by the avc-telemetry tool).
+   */
+  struct TelemetryRecord {
+    /**
+     * Identifies what the command specific values hold (see {@link
+     * #getLabels}).
+     */
+    enum Kind {
+      /** No command specific values. */
+      TICK = 0,
+
+      /** DriveToTurn: turned, powerCorrect. */
+      DRIVE_TO_TURN = 1,
+
+      /** MakeTurn: turned, err, steer. */
+      MAKE_TURN = 2,
+
+      /** MakeSmoothTurn: turned. */
+      MAKE_SMOOTH_TURN = 3,
+
+      /** DriveStraight: desiredHeading, heading, angErr, left, right, redCnt, yelCnt, correction. */
+      DRIVE_STRAIGHT = 4,
+
+      NUM_KINDS = 5
+    };
+
+    // Maximum number of command specific values
+    static const int MAX_VALUES = 8;
+
+    // Maximum length of command name stored (not nul terminated if full)
+    static const int NAME_LEN = 16;
+
+    // CLOCK_MONOTONIC time (nanoseconds) record was made
+    int64_t timeNanos;
+    // Increments with each record
+    uint32_t seq;
+    // What values[] holds (Kind)
+    uint16_t kind;
+    // Number of values[] used
+    uint16_t numValues;
+    // Name of command being run (truncated)
+    char command[NAME_LEN];
+    // Seconds since command started
+    float elapsed;
+    // Motor power levels and heading
+    float left;
+    float right;
+    float heading;
+    // Vision information
+    int32_t frameCount;
+    int16_t found;
+    int16_t boxHeight;
+    uint8_t inTurn;
+    uint8_t reserved[3];
+    // Command specific values
+    float values[MAX_VALUES];
+
+    /**
+     * Returns the names of the command specific values for a kind
+     * (array is terminated by a null pointer).
+     */
+    static const char* const* getLabels(int kind);
+
+    /**
+     * Prints a text version of the record (similar to Timon::print).
+     */
+    std::ostream& print(std::ostream& out) const;
+  };
+
+  /**
+   * Collects telemetry records from the control loop and writes them
+   * to a binary file from a background thread.
+   *
+   * <p>Records are copied into a single producer/single consumer ring
+   * (no locks, formatting or I/O on the control loop). The flush
+   * thread periodically writes everything in the ring straight from
+   * ring memory to the log file. If the flush thread falls behind and
+   * the ring fills up, new records are dropped (and counted) rather
+   * than blocking the control loop.</p>
+   *
+   * <p>The file starts with a TelemetryLog::Header followed by
+   * TelemetryRecord structures (in native byte order).</p>
+   */
+  class TelemetryLog {
+
+  public:
+    // Identifies a telemetry file
+    static const uint32_t MAGIC = 0x54435641;
+
+    // Number of records the ring can hold (must be power of 2)
+    static const uint32_t CAPACITY = 4096;
+
+    /**
+     * Start of the telemetry file.
+     */
+    struct Header {
+      uint32_t magic;
+      uint32_t recordSize;
+    };
+
+    TelemetryLog();
+
+    /** Flushes any remaining records and closes the file. */
+    ~TelemetryLog();
+
+    /**
+     * Creates (truncates) the log file and starts the flush thread.
+     *
+     * @param path The file to write records to.
+     *
+     * @return true if file opened and flush thread started.
+     */
+    bool open(const std::string& path);
+
+    /**
+     * Stops the flush thread (after writing remaining records) and
+     * closes the file.
+     */
+    void close();
+
+    /** Returns true if log file is open. */
+    bool isOpen() const { return _fd >= 0; }
+
+    /**
+     * Adds a record (safe to call from one thread only - the control loop).
+     *
+     * <p>The seq field is filled in for you.</p>
+     *
+     * @return true if record was added, false if log not open or the
+     * ring was full (record dropped).
+     */
+    bool add(const TelemetryRecord& rec);
+
+    /** Number of records dropped because the ring was full. */
+    uint32_t getDropped() const;
+
+    /** Number of records written to the file. */
+    uint32_t getWritten() const;
+
+    /** Current Clock time in nanoseconds (for timeNanos). */
+    static int64_t nowNanos();
+
+  private:
+    TelemetryLog(const TelemetryLog&);
+    TelemetryLog& operator=(const TelemetryLog&);
+
+    // Entry point of the flush thread
+    void run();
+
+    // Writes all records in the ring to the file (returns number written)
+    int flush();
+
+    int _fd;
+    std::thread _flusher;
+    bool _running;
+
+    // Ring of records (producer advances _head, flusher advances _tail)
+    TelemetryRecord* _ring;
+    uint32_t _head;
+    uint32_t _tail;
+
+    uint32_t _seq;
+    uint32_t _dropped;
+    uint32_t _written;
+  };
+
+  inline std::ostream& operator<<(std::ostream& out, const TelemetryRecord& rec) {
+    return rec.print(out);
+  }
+
+}
+
+#endif
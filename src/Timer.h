@@ -4,6 +4,9 @@
 #ifndef __avc_Timer_h
 #define __avc_Timer_h
 
+#include "Clock.h"
+
+#include <chrono>
 #include <iostream>
 
 #include <time.h>
@@ -11,16 +14,27 @@
 namespace avc {
 
   /**
-   * Timer class wrapper the clock_gettime function that gets a
-   * monotonic time (see: "man 3 clock_gettime").
+   * Timer class wrapper around the Clock (the monotonic time or the
+   * virtual time of a simulation - see Clock::setSource).
+   *
+   * <p>Time stamps are kept as 64 bit integer nanoseconds, so elapsed
+   * times are exact no matter how long the system has been up (the
+   * float seconds methods only round the final result). The
+   * std::chrono methods use the ChronoClock time line.</p>
    */
   class Timer {
 
   public:
 
+    /** Exact time stamp (see Clock::nowNanos). */
+    typedef ChronoClock::time_point TimePoint;
+
+    /** Exact length of time. */
+    typedef ChronoClock::duration Duration;
+
     /**
-     * Wrapper around the nanosleep function to sleep for a precise
-     * amount of time.
+     * Sleeps for a precise amount of time (or just moves virtual time
+     * forward - see Clock).
      *
      * @param seconds The number of seconds to sleep (you can specify
      * very small amounts of time).
@@ -33,28 +47,72 @@ namespace avc {
     static float sleep(float seconds);
 
     /**
-     * Used for short sleep times (less than a second).
+     * Sleeps for a std::chrono length of time (like
+     * std::chrono::milliseconds(50)).
+     *
+     * @return The time NOT slept (zero unless interrupted).
+     */
+    template <class Rep, class Period>
+    static Duration sleep(const std::chrono::duration<Rep, Period>& howLong) {
+      return Duration(sleepNanos(std::chrono::duration_cast<Duration>(howLong).count()));
+    }
+
+    /**
+     * Sleeps for a number of nanoseconds.
      *
-     * @param nanos How many nanoseconds to sleep in the range of [0,
-     * 999,999,999].
+     * @param nanos How many nanoseconds to sleep (any amount, not
+     * limited to a second).
      *
      * @return 0 If sleep successful, otherwise, the number of nanos
      * still needing to sleep.
      */
-    static int sleepNanos(int nanos);
-    
+    static int64_t sleepNanos(int64_t nanos);
+
+    /**
+     * Gets the current time stamp (the start of the current tick
+     * while one is running - see Clock::Tick).
+     *
+     * @return Nanoseconds on the monotonic time line of the Clock.
+     */
+    static int64_t nowNanos() {
+      return Clock::tickNanos();
+    }
+
+    /**
+     * Same as {@link #nowNanos} as a std::chrono time point.
+     */
+    static TimePoint now() {
+      return ChronoClock::fromNanos(nowNanos());
+    }
+
     /**
-     * Gets a high precision time stamp that ignores real-time adjustments.
+     * Gets a high precision time stamp that ignores real-time adjustments
+     * (the start of the current tick while one is running - see
+     * Clock::Tick).
      *
      * @param storeIn Where to store the results.
      *
-     * @return true If successfully got time, false if not (check
-     * errno - see "man clock_gettime" for details).
+     * @return true If successfully got time (the time comes from the
+     * Clock of the current thread which can not fail).
      */
     static bool getTime(timespec& storeIn) {
-      storeIn.tv_sec = 0;
-      storeIn.tv_nsec = 0;
-      return clock_gettime(CLOCK_MONOTONIC_RAW, &storeIn) == 0;
+      int64_t now = nowNanos();
+      storeIn.tv_sec = (time_t) (now / NANOS_PER_SEC);
+      storeIn.tv_nsec = (long) (now % NANOS_PER_SEC);
+      return true;
+    }
+
+    /**
+     * Computes the exact difference between two time stamps.
+     *
+     * @param fromHere The starting point in time.
+     * @param toHere The ending point in time.
+     *
+     * @returns (toHere - fromHere) as a number of nanoseconds.
+     */
+    static int64_t diffNanos(const timespec& fromHere, const timespec& toHere) {
+      return ((int64_t) toHere.tv_sec - fromHere.tv_sec) * NANOS_PER_SEC
+        + ((int64_t) toHere.tv_nsec - fromHere.tv_nsec);
     }
 
     /**
@@ -65,7 +123,31 @@ namespace avc {
      *
      * @returns (toHere - fromHere) as a number of seconds.
      */
-    static float diffSecs(const timespec& fromHere, const timespec& toHere);
+    static float diffSecs(const timespec& fromHere, const timespec& toHere) {
+      return toSecs(diffNanos(fromHere, toHere));
+    }
+
+    /**
+     * Converts nanoseconds to seconds (rounded only once, at the end).
+     */
+    static float toSecs(int64_t nanos) {
+      return (float) (nanos / 1e9);
+    }
+
+    /**
+     * Converts seconds to the nearest nanosecond.
+     */
+    static int64_t toNanos(double secs) {
+      return (int64_t) ((secs < 0) ? (secs * 1e9 - 0.5) : (secs * 1e9 + 0.5));
+    }
+
+    /**
+     * Converts a std::chrono length of time to nanoseconds.
+     */
+    template <class Rep, class Period>
+    static int64_t toNanos(const std::chrono::duration<Rep, Period>& howLong) {
+      return std::chrono::duration_cast<Duration>(howLong).count();
+    }
 
     /**
      * Indicates whether the timer is running or paused.
@@ -79,9 +161,9 @@ namespace avc {
      * and puts timer in a running state).
      */
     bool start() {
-      Timer::getTime(startTime);
-      endTime = startTime;
+      startNanos = endNanos = nowNanos();
       running = true;
+      return true;
     }
 
     /**
@@ -89,9 +171,9 @@ namespace avc {
      * time will return 0.0 until you unpause it).
      */
     bool startPaused() {
-      Timer::getTime(startTime);
-      endTime = startTime;
+      startNanos = endNanos = nowNanos();
       running = false;
+      return true;
     }
 
     /**
@@ -99,8 +181,9 @@ namespace avc {
      * running state).
      */
     bool pause() {
-      Timer::getTime(endTime);
+      endNanos = nowNanos();
       running = false;
+      return true;
     }
 
     /**
@@ -109,6 +192,7 @@ namespace avc {
      */
     bool unpause() {
       running = true;
+      return true;
     }
 
     /**
@@ -116,8 +200,9 @@ namespace avc {
      * so elapsed time will come back as 0.
      */
     bool zero() {
-      endTime = startTime;
+      endNanos = startNanos;
       running = false;
+      return true;
     }
 
     /**
@@ -137,10 +222,21 @@ namespace avc {
      * }
      * </pre>
      *
-     * @param nanoPeriod How long the time period should be (in the
-     * range of [0, 999,999,999]).
+     * @param nanoPeriod How long the time period should be (periods
+     * are measured from the start time, any length greater than 0).
+     *
+     * @return 0 If sleep successful, otherwise, the number of nanos
+     * still needing to sleep.
+     */
+    int64_t sleepUntilNextNano(int64_t nanoPeriod) const;
+
+    /**
+     * Same as {@link #sleepUntilNextNano} for a std::chrono period.
      */
-    int sleepUntilNextNano(int nanoPeriod) const;
+    template <class Rep, class Period>
+    Duration sleepUntilNext(const std::chrono::duration<Rep, Period>& period) const {
+      return Duration(sleepUntilNextNano(toNanos(period)));
+    }
 
     /**
      * Determines the number of seconds which have elapsed.
@@ -150,7 +246,38 @@ namespace avc {
      * paused. If the timer is still running, this method returns the
      * number of seconds from when the timer was last started to now.
      */
-    float secsElapsed() const;
+    float secsElapsed() const {
+      return toSecs(nanosElapsed());
+    }
+
+    /**
+     * Same as {@link #secsElapsed}, but as an exact number of
+     * nanoseconds.
+     */
+    int64_t nanosElapsed() const {
+      return (running ? nowNanos() : endNanos) - startNanos;
+    }
+
+    /**
+     * Same as {@link #nanosElapsed} as a std::chrono duration.
+     */
+    Duration elapsed() const {
+      return Duration(nanosElapsed());
+    }
+
+    /**
+     * When the timer was last started (nanoseconds, see Clock::nowNanos).
+     */
+    int64_t getStartNanos() const {
+      return startNanos;
+    }
+
+    /**
+     * Same as {@link #getStartNanos} as a std::chrono time point.
+     */
+    TimePoint getStartTime() const {
+      return ChronoClock::fromNanos(startNanos);
+    }
 
     /**
      * Construct a new Timer instance and "start" it.
@@ -169,8 +296,8 @@ namespace avc {
      * @param t The other Timer to copy values from.
      */
     Timer(const Timer& t) :
-      startTime(t.startTime),
-      endTime(t.endTime),
+      startNanos(t.startNanos),
+      endNanos(t.endNanos),
       running(t.running) {
     }
 
@@ -180,10 +307,12 @@ namespace avc {
     std::ostream& printJson(std::ostream& out) const;
 
   private:
-    // processor clock timestamp when timer started
-    timespec startTime;
-    // processor clock timestamp when timer paused
-    timespec endTime;
+    static const int64_t NANOS_PER_SEC = 1000000000LL;
+
+    // Clock time stamp (nanoseconds) when timer started
+    int64_t startNanos;
+    // Clock time stamp (nanoseconds) when timer paused
+    int64_t endNanos;
     // Whether we are in a runing or paused state
     bool running;
   };
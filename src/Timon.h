@@ -5,74 +5,75 @@
 #ifndef __avc_Timon_h
 #define __avc_Timon_h
 
-#define USE_SERVOS 0
-
+#include "AutonPlan.h"
+#include "CommandArena.h"
 #include "CommandParallel.h"
-#if USE_SERVOS
-#include "Servo.h"
-#else
-#include "HBridge.h"
-#endif
-
-#include "GyroBNO055.h"
-
-#include <fstream>
+#include "FlightRecorder.h"
+#include "Hal.h"
+#include "Pid.h"
+#include "Reactor.h"
+#include "SensorRecorder.h"
+#include "Telemetry.h"
 
-enum Found: int {
-    None,
-        Red,
-        Yellow,
-        };
+#include <initializer_list>
+#include <iostream>
+#include <string>
 
-struct FileData {
-    int frameCount; 
-    Found found;
+namespace avc {
 
-    int boxWidth, boxHeight;
-    int xMid, yBot;
+    /**
+     * Gains and power levels used by Timon's commands (kept together
+     * so they can be changed without a rebuild, for example by the
+     * avc-sim parameter sweeps).
+     */
+    struct TimonTuning {
+        // Base power DriveStraight drives at
+        float drivePower;
+        // Most power DriveStraight puts on a side (multiple of drivePower)
+        float maxDriveRatio;
+        // DriveStraight heading gains (fraction of power per degree
+        // and per degree/sec, no I)
+        float straightP;
+        float straightD;
+        // MakeTurn heading gains (power per degree and per degree/sec, no I)
+        float turnP;
+        float turnD;
+        // Time constant of the filter on the D terms (0 for none)
+        float derivFilterSecs;
+        // Most power MakeTurn uses to steer
+        float turnMaxMag;
+        // Least power MakeTurn uses to steer (while the car is moving)
+        float turnBaseMinMag;
+
+        /** Fills in the values tuned on the track. */
+        TimonTuning();
 
-    int safetyFrameCount;
+        /**
+         * Changes a value by name (like "straightP").
+         *
+         * @return false if there is no value with that name.
+         */
+        bool set(const std::string& name, float value);
 
-    // Zeros contents (which results in Found::None)
-    void clear() { memset((char*) this, 0, sizeof(FileData)); }
+        /** Writes all of the values as name=value pairs. */
+        std::ostream& print(std::ostream& out) const;
+    };
 
-    // Let constructor clear contents
-    FileData() { clear(); }
-};
+    inline std::ostream& operator<<(std::ostream& out, const TimonTuning& tuning) {
+        return tuning.print(out);
+    }
 
-namespace avc {
     /**
      * Definition of the RC car to control.
      */
     class Timon : public CommandParallel {
 
     private:
-        // The "map" of GPIO pins (how things need to be wired)
-
-        // P9 pin 16 (GPIO 51)
-        static const BlackLib::pwmName RIGHT_PWM = BlackLib::P9_16;
-        // P9 pin 17 (GPIO 5)
-        static const BlackLib::gpioName RIGHT_GPIO_FWD = BlackLib::GPIO_5;
-        // P9 pin 23 (GPIO 49)
-        static const BlackLib::gpioName RIGHT_GPIO_REV = BlackLib::GPIO_49;
-
-        // P9 pin 21 (GPIO 3)
-        static const BlackLib::pwmName LEFT_PWM = BlackLib::P9_21;
-        // P9 pin 15 (GPIO 48)
-        static const BlackLib::gpioName LEFT_GPIO_FWD = BlackLib::GPIO_48;
-        // P9 pin 12 (GPIO 60)
-        static const BlackLib::gpioName LEFT_GPIO_REV = BlackLib::GPIO_60;
+        Hal::Motor _left;
+        Hal::Motor _right;
 
-    private:
-#if USE_SERVOS
-        Servo _left;
-        Servo _right;
-#else
-        HBridge _left;
-        HBridge _right;
-#endif
-        // Gyro to track direction of car
-        GyroBNO055 _gyro;
+        // Gyro to track direction of car (read on a background thread)
+        Hal::HeadingSensor _gyro;
 
         // Initial reading of the gyro at the start of the run
         float _initHeading;
@@ -95,8 +96,11 @@ namespace avc {
         // Will be true once we've reached the final point in our drive
         bool _done;
 
-        // A file handle to the stanchion data
-        std::ifstream _stanchionsFile;
+        // Stanchion data published by avc-vision
+        Hal::VisionSource _vision;
+
+        // Frames read from avc-vision on the current tick
+        VisionFrame _visionFrames[VisionRing::CAPACITY];
 
 	// Frame ID on vision record of last time we saw a stanchion
 	int _lastStanchionFrame;
@@ -109,6 +113,62 @@ namespace avc {
         // Previous vision information record (in case you want to compare)
         FileData _fileDataPrev;
 
+        // Lets us know when avc-vision has published a new frame
+        NotifySource _visionNotify;
+
+        // Time since we last read the vision record
+        Timer _visionReadTimer;
+
+        // Per tick records written by a background thread
+        TelemetryLog _telemetry;
+
+        // Memory mapped record of the last few minutes (survives crashes)
+        FlightRecorder _flight;
+
+        // Memory mapped record of what each tick read (for avc-replay)
+        SensorRecorder _sensors;
+
+        // Readings of the current tick (while recording sensors)
+        SensorTick _sensorTick;
+
+        // Which auton was last loaded
+        bool _longWay;
+
+        // Steps of the compiled plan last loaded (0 for the built in autons)
+        const AutonPlan* _autonPlan;
+
+        // Timer driving the control loop (for tick lateness)
+        const PeriodicTimer* _tickTimer;
+
+        // When the current tick started and how long since the prior one
+        int64_t _tickNanos;
+        float _tickSecs;
+
+        // Set when the process has been asked to stop
+        const bool* _interrupted;
+
+        // Gains and power levels used by the commands
+        TimonTuning _tuning;
+
+        // Owns the commands of the loaded auton (rebuilt in place each run)
+        CommandArena _plan;
+
+        // Drops the commands of the current auton and returns the empty arena
+        CommandArena& resetPlan();
+
+        // Reads the latest record published by avc-vision
+        void readVision();
+
+        // Marks car as crashed if we haven't seen a stanchion in a while
+        void checkStanchionTimeout();
+
+        // Adds the state at the end of the current tick to the flight recorder
+        void recordFlight();
+
+        // Adds the readings and motor power of the current tick to the
+        // sensor recording
+        void recordSensors(SensorTick::Kind kind, Command::State state);
+
     public:
 
         /**
@@ -128,6 +188,15 @@ namespace avc {
          */
         void setAutonShortWay();
 
+        /**
+         * Load in the steps of a compiled plan (see AutonPlan and the
+         * avc-plan tool) instead of one of the built in autons.
+         *
+         * @param plan The validated steps to run (copied).
+         * @param longWay Which way around the road the plan drives.
+         */
+        void setAuton(const AutonPlan& plan, bool longWay);
+
         /**
          * Returns true if we've detected a crashed situation along the way.
          */
@@ -143,6 +212,19 @@ namespace avc {
          */
         void readSensors();
 
+        /**
+         * Only read the vision record when avc-vision says a new frame
+         * is available and wake the control loop when it does.
+         *
+         * @param reactor The Reactor used to run the control loop.
+         *
+         * @param fifoPath The named FIFO avc-vision writes a byte to
+         * after publishing each frame.
+         *
+         * @return true if the FIFO was opened and is being watched.
+         */
+        bool watchVision(Reactor& reactor, const std::string& fifoPath);
+
 	/**
 	 * Gets the specified counter
 	 */
@@ -231,12 +313,12 @@ namespace avc {
          *
          * @param power The goal we eventually want to reach.
          *
-         * @param maxStep The maximum change we are allowed to make to the
-         * current power level each time this method is called.
+         * @param maxPerSec The maximum change we are allowed to make to
+         * the current power level per second (spread over the ticks).
          */
-        void seekSpeed(float power, float maxStep = 0.05) {
-            _left.seek(power, maxStep);
-            _right.seek(power, maxStep);
+        void seekSpeed(float power, float maxPerSec = 1.0) {
+            _left.seek(power, maxPerSec * _tickSecs);
+            _right.seek(power, maxPerSec * _tickSecs);
         }
 
         /**
@@ -248,12 +330,13 @@ namespace avc {
          * @param rightPower The desired power output for the right side
          * (range of [-1, +1].
          *
-         * @param maxStep The maximum change we are allowed to make to the
-         * current power output to the motors.
+         * @param maxPerSec The maximum change we are allowed to make to
+         * the current power output to the motors per second (spread
+         * over the ticks).
          */
-        void seekDrive(float leftPower, float rightPower, float maxStep = 0.05) {
-            _left.seek(leftPower, maxStep);
-            _right.seek(rightPower, maxStep);
+        void seekDrive(float leftPower, float rightPower, float maxPerSec = 1.0) {
+            _left.seek(leftPower, maxPerSec * _tickSecs);
+            _right.seek(rightPower, maxPerSec * _tickSecs);
         }
 
         /**
@@ -298,10 +381,123 @@ namespace avc {
          */
         std::ostream& print(std::ostream& out, const Command& cmd) const;
 
+        /**
+         * Logs the current state of the vehicle to the telemetry file
+         * (use instead of print() on every tick - it only copies a
+         * fixed size record and never formats text or blocks).
+         *
+         * @param cmd The command reporting.
+         * @param kind What the values are (see TelemetryRecord::Kind).
+         * @param values Command specific values (up to MAX_VALUES).
+         */
+        void record(const Command& cmd, TelemetryRecord::Kind kind,
+                    std::initializer_list<float> values = {});
+
+        /**
+         * Starts writing telemetry records to a binary file (decode with
+         * the avc-telemetry tool).
+         *
+         * @return true if file opened.
+         */
+        bool openTelemetry(const std::string& path) {
+            return _telemetry.open(path);
+        }
+
+        /**
+         * Starts keeping the state of every tick in a memory mapped
+         * flight recorder file (dump with the avc-flight tool).
+         *
+         * @return true if file created and mapped.
+         */
+        bool openFlightRecorder(const std::string& path) {
+            return _flight.open(path);
+        }
+
+        /**
+         * Starts recording the sensor readings and motor power of every
+         * tick of each run in a memory mapped file (replay with the
+         * avc-replay tool).
+         *
+         * @return true if file created and mapped.
+         */
+        bool openSensorRecorder(const std::string& path) {
+            return _sensors.open(path);
+        }
+
+        /**
+         * Time stamp taken at the start of the current tick (the same
+         * for every command executed in the tick - see Clock::Tick).
+         */
+        int64_t getTickNanos() const { return _tickNanos; }
+
+        /**
+         * Seconds between the start of the prior tick and the current
+         * one (0 on the tick the car was initialized).
+         */
+        float getTickSecs() const { return _tickSecs; }
+
+        /** Returns true if the long way auton was loaded last. */
+        bool isLongWay() const { return _longWay; }
+
+        /**
+         * Sets the timer driving the control loop so the flight
+         * recorder can note how late each tick was.
+         *
+         * @param timer The timer (or a null pointer if not known).
+         */
+        void setTickTimer(const PeriodicTimer* timer) { _tickTimer = timer; }
+
+        /**
+         * Sets the flag which is set when the process is asked to stop
+         * (the car is considered crashed once it is set).
+         */
+        void setInterruptedFlag(const bool* flag) { _interrupted = flag; }
+
+        /** Gains and power levels used by the commands. */
+        const TimonTuning& getTuning() const { return _tuning; }
+
+        /** Changes the gains and power levels (takes effect immediately). */
+        void setTuning(const TimonTuning& tuning) { _tuning = tuning; }
+
+        /** Motor driving one side of the car. */
+        Hal::Motor& getMotor(MotorSide side) {
+            return (side == LEFT_MOTOR) ? _left : _right;
+        }
+
+        /** Sensor used to track the heading of the car. */
+        Hal::HeadingSensor& getHeadingSensor() { return _gyro; }
+
+        /** Source of the stanchion information. */
+        Hal::VisionSource& getVisionSource() { return _vision; }
+
     private:
         
     };
 
+    /**
+     * Command which shows what the vision system is seeing on the user
+     * LEDs (never ends, add it in parallel with the drive commands).
+     */
+    class StatusLeds : public Command {
+
+    public:
+
+        /**
+         * Construct a new instance.
+         *
+         * @param car Reference to the vehicle to report on.
+         *
+         * @param period How often (in seconds) to update the LEDs
+         * (defaults to 5 Hz - no need to update LEDs at loop rate).
+         */
+        StatusLeds(Timon& car, float period = 0.2);
+
+        Command::State doExecute();
+
+    private:
+        Timon& _car;
+    };
+
     /**
      * Command to drive at preset power levels for a specific amount of time.
      */
@@ -374,9 +570,10 @@ namespace avc {
         // How much to turn (in signed degrees)
         float _turn;
         float _initialHeading;
-        float _lastErr;
+        Pid _pid;
 	float _lastCarTurned;
-        int _inRangeCnt;
+        // When the car came within range of the turn (-1 if not in range)
+        int64_t _inRangeNanos;
     };
 
     /**
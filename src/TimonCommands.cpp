@@ -0,0 +1,801 @@
+/**
+ * Implementation of the Timon class and the commands used to drive it.
+ */
+
+#include "CommandSequence.h"
+#include "Timon.h"
+#include "TimonDriveStraight.h"
+#include "TimonPlan.h"
+#include "Brake.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+#include <sys/epoll.h>
+
+using namespace avc;
+using namespace std;
+
+namespace {
+    // Where avc-vision publishes the results of each frame
+    const char* VISION_FILE = "/dev/shm/stanchions";
+
+    // Names of the values in TimonTuning
+    struct TuningField {
+        const char* name;
+        float TimonTuning::* value;
+    };
+
+    const TuningField tuningFields[] = {
+        { "drivePower", &TimonTuning::drivePower },
+        { "maxDriveRatio", &TimonTuning::maxDriveRatio },
+        { "straightP", &TimonTuning::straightP },
+        { "straightD", &TimonTuning::straightD },
+        { "turnP", &TimonTuning::turnP },
+        { "turnD", &TimonTuning::turnD },
+        { "derivFilterSecs", &TimonTuning::derivFilterSecs },
+        { "turnMaxMag", &TimonTuning::turnMaxMag },
+        { "turnBaseMinMag", &TimonTuning::turnBaseMinMag }
+    };
+
+    const int tuningFieldCount = sizeof(tuningFields) / sizeof(tuningFields[0]);
+
+    // Memory taken for the auton commands before the run starts (the
+    // built in short way, the largest plan, needs about 5 KB)
+    const size_t planArenaBytes = 16384;
+}
+
+//
+// Implementation of the TimonTuning methods
+//
+
+TimonTuning::TimonTuning() :
+    drivePower(0.15f),
+    maxDriveRatio(1.5f),
+    // D gains were tuned as a change per 20 Hz tick, scaled to per second
+    straightP(0.04f),
+    straightD(0.025f / 20),
+    turnP(0.10f * 10.0f / 360.0f),
+    turnD(0.1f * 10.0f / 360.0f / 20),
+    derivFilterSecs(0.02f),
+    turnMaxMag(0.35f),
+    turnBaseMinMag(0.05f)
+{
+}
+
+bool TimonTuning::set(const string& name, float value) {
+    for (int i = 0; i < tuningFieldCount; i++) {
+        if (name == tuningFields[i].name) {
+            this->*tuningFields[i].value = value;
+            return true;
+        }
+    }
+    return false;
+}
+
+ostream& TimonTuning::print(ostream& out) const {
+    for (int i = 0; i < tuningFieldCount; i++) {
+        out << ((i == 0) ? "" : " ") << tuningFields[i].name << "=" << this->*tuningFields[i].value;
+    }
+    return out;
+}
+
+//
+// Implementation of the Timon class methods
+//
+
+Timon::Timon() :
+    CommandParallel("Timon", true, &_plan),
+    _left(LEFT_MOTOR),
+    _right(RIGHT_MOTOR),
+    _gyro(),
+    _initHeading(0),
+    _heading(0),
+    _wayPoint(1),
+    _crashed(false),
+    _inTurn(false),
+    _done(false),
+    _vision(),
+    _lastStanchionFrame(0),
+    _lastStanchionTimer(),
+    _fileData(),
+    _fileDataPrev(),
+    _visionNotify(),
+    _visionReadTimer(),
+    _telemetry(),
+    _flight(),
+    _sensors(),
+    _sensorTick(),
+    _longWay(false),
+    _autonPlan(0),
+    _tickTimer(0),
+    _tickNanos(0),
+    _tickSecs(0),
+    _interrupted(0),
+    _tuning(),
+    _plan()
+{
+    if (!_gyro.start()) {
+        _crashed = true;
+    }
+    _vision.open(VISION_FILE);
+
+    // So building the auton after the button press doesn't hit the heap
+    _plan.reserve(planArenaBytes);
+}
+
+void doTurns(Timon& timon, CommandArena& plan, CommandSequence* drive) {
+    // Give .25 seconds to let user move hand away
+    drive->add(plan.make<DrivePowerTime>(timon, 0, 0, 0.25));
+
+    // How many turns to make
+    const float numberOfTurns = 4;
+
+    for (int i = 0; i < numberOfTurns; i++) {
+		// Make a right hand turn
+		drive->add(plan.make<MakeTurn>(timon, 90.0));
+    }
+
+}
+
+void doStop(Timon& timon, CommandArena& plan, CommandSequence* drive) {
+	drive->add(plan.make<DriveStraight>(timon, 0, 2.0, true));
+	drive->add(plan.make<Brake>(timon, 1.0));
+}
+
+void Timon::setAutonLongWay() {
+    CommandArena& plan = resetPlan();
+    _longWay = true;
+
+	auto drive = plan.make<CommandSequence>("Drive", &plan);
+
+	//doTurns(*this, plan, drive);
+	doStop(*this, plan, drive);
+
+    drive->print(cout) << " (" << plan.getUsed() << " bytes)\n";
+
+    add(drive);
+    add(plan.make<StatusLeds>(*this));
+}
+
+void Timon::setAutonShortWay() {
+    CommandArena& plan = resetPlan();
+    _longWay = false;
+
+    CommandSequence* drive = plan.make<CommandSequence>("Drive", &plan);
+    // Give .25 seconds to let user move hand away
+    drive->add(plan.make<DrivePowerTime>(*this, 0, 0, 0.25));
+
+    // Uncomment to spin left side forward one second followed
+    // by right side forward for a second to verify logic is right
+    //drive->add(plan.make<DrivePowerTime>(*this, 0.2, 0, 1.0));
+
+    // Make a left hand turn
+    //    drive->add(plan.make<DriveToTurn>(*this, 0.2, 10.0));
+    const float numberOfTurns = 4;
+	float curAng = 0;
+
+    for (int i = 0; i < numberOfTurns; i++) {
+	    // Experiment with "driving straight" command
+	    drive->add(plan.make<DriveStraight>(*this, curAng, 2.0, false));
+
+		// Brake
+		drive->add(plan.make<Brake>(*this, 1.0));
+
+		// Reverse
+		drive->add(plan.make<DrivePowerTime>(*this, -0.15, -0.15, 0.6));
+
+		// And brake again, just to make sure
+		drive->add(plan.make<Brake>(*this, 0.5));
+
+	    // Make a right hand turn
+	    drive->add(plan.make<MakeTurn>(*this, 90.0));
+
+		curAng += 90;
+    }
+
+    drive->print(cout) << " (" << plan.getUsed() << " bytes)\n";
+
+    add(drive);
+    add(plan.make<StatusLeds>(*this));
+}
+
+void Timon::setAuton(const AutonPlan& steps, bool longWay) {
+    CommandArena& plan = resetPlan();
+    _longWay = longWay;
+
+    PlanExecutor* drive = plan.make<PlanExecutor>(*this, steps);
+    _autonPlan = &drive->getPlan();
+    drive->print(cout) << " (" << plan.getUsed() << " bytes)\n";
+
+    add(drive);
+    add(plan.make<StatusLeds>(*this));
+}
+
+CommandArena& Timon::resetPlan() {
+    // Children go before the arena destroys them
+    clear();
+    _plan.reset();
+    _autonPlan = 0;
+    return _plan;
+}
+
+Timon::~Timon() { 
+    clear();
+    _left.set(0);
+    _right.set(0);
+    _left.disable();
+    _right.disable();
+}
+
+void Timon::doInitialize() {
+    _sensorTick.timeNanos = _tickNanos = Clock::tickNanos();
+    _tickSecs = 0;
+    _crashed = _done = false;
+    _wayPoint = 1;
+
+    // Used to keep track of how long since we've seen a stanchion
+    _lastStanchionTimer.start();
+    _lastStanchionFrame = 0;
+
+    // Clear vision record (0 values and set found to None)
+    _fileData.clear();
+    _fileDataPrev.clear();
+
+    memset(_stanchionCounts, 0, sizeof(_stanchionCounts));
+
+    // In case avc-vision was not up yet when we were constructed
+    if (!_vision.isOpen()) {
+        _vision.open(VISION_FILE);
+    }
+    // Only interested in frames from now on
+    _vision.skipToLatest();
+
+    // Sampler may not have a reading yet if it was just started
+    GyroSample sample;
+    bool gyroOk = _gyro.getLatest(sample);
+    for (int i = 0; !gyroOk && _gyro.isRunning() && (i < 10); i++) {
+        Timer::sleepNanos(10000000);
+        gyroOk = _gyro.getLatest(sample);
+    }
+
+    if (gyroOk) {
+        _initHeading = sample.data.heading;
+    } else {
+        _crashed = true;
+        cerr << "***ERROR*** Gyro not responding (unable to read heading)\n";
+    }
+
+    CommandParallel::doInitialize();
+
+    if (_sensors.isOpen()) {
+        _sensors.start(_longWay, _autonPlan);
+        _sensorTick.gyroOk = gyroOk;
+        _sensorTick.gyro = sample;
+        _sensorTick.visionRead = 0;
+        _sensorTick.visionOk = 1;
+        _sensorTick.frameCount = 0;
+        recordSensors(SensorTick::INITIALIZE, Command::STILL_RUNNING);
+    }
+}
+
+void Timon::readSensors() {
+    // If process interrupted, consider car as crashed
+    if ((_interrupted != 0) && *_interrupted) {
+	_crashed = true;
+	cerr << "***ERROR*** Interrupted process\n";
+    }
+
+    // Newest reading from the sampler thread (never waits on I2C bus)
+    GyroSample sample;
+    bool gyroOk = _gyro.getLatest(sample);
+    if (_sensors.isOpen()) {
+        _sensorTick.gyroOk = gyroOk;
+        _sensorTick.gyro = sample;
+        _sensorTick.visionRead = 0;
+        _sensorTick.visionOk = 1;
+        _sensorTick.frameCount = 0;
+    }
+
+    if (gyroOk) {
+        float heading = sample.data.heading - _initHeading;
+        if (heading < 0) {
+            heading += 360.0;
+        }
+        _heading = heading;
+    } else {
+        _crashed = true;
+        cerr << "***ERROR*** Gyro not responding (no recent heading, failed reads: "
+             << _gyro.getFailures() << ")\n";
+    }
+
+    //
+    // If avc-vision notifies us of new frames, only read the vision
+    // record when there is a new frame (or if it has been quiet for
+    // too long)
+    //
+    const float maxVisionQuietTime = 0.1;
+    if (!_visionNotify.isOpen() || _visionNotify.consume() ||
+        (_visionReadTimer.secsElapsed() >= maxVisionQuietTime)) {
+        readVision();
+    }
+
+    checkStanchionTimeout();
+}
+
+void Timon::readVision() {
+    _visionReadTimer.start();
+
+    //
+    // Try to read in every frame published since the last tick (so
+    // counts see every transition even if we run slower than camera)
+    //
+    int n = _vision.drain(_visionFrames, VisionRing::CAPACITY);
+    bool fileOk = (n >= 0);
+
+    if (_sensors.isOpen()) {
+        _sensorTick.visionRead = 1;
+        _sensorTick.visionOk = fileOk;
+        _sensorTick.frameCount = n;
+        // Keep the newest frames if there are too many
+        int first = max(0, n - SensorTick::MAX_FRAMES);
+        for (int i = first; i < n; i++) {
+            _sensorTick.frames[i - first] = _visionFrames[i];
+        }
+    }
+
+    for (int i = 0; i < n; i++) {
+	const FileData& data = _visionFrames[i].data;
+
+	// If this is a new frame, store previous info
+	if (_fileData.frameCount != data.frameCount) {
+	    _fileDataPrev = _fileData;
+
+	    if (data.found != _fileDataPrev.found) {
+		_stanchionCounts[_fileData.found]++;
+	    }
+	}
+	_fileData = data;
+    }
+
+    if (fileOk == false) {
+		_fileData.found = Found::None;
+		_crashed = true;
+		cerr << "***ERROR*** Failed to read valid record from stanchion file\n";
+    }
+}
+
+bool Timon::watchVision(Reactor& reactor, const std::string& fifoPath) {
+    if (!_visionNotify.openFifo(fifoPath)) {
+        return false;
+    }
+    bool ok = reactor.add(_visionNotify.getFd(), EPOLLIN, _visionNotify);
+    _visionNotify.setWatched(ok);
+    return ok;
+}
+
+void Timon::checkStanchionTimeout() {
+    //
+    // Check how long it's been since we've had a new image of a stanchion
+    //
+    if ((_fileData.found != Found::None) &&
+	(_fileData.frameCount != _lastStanchionFrame)) {
+	_lastStanchionFrame = _fileData.frameCount;
+	_lastStanchionTimer.start();
+    } else {
+	//float maxTimeToWait = 2.0;
+	const float maxTimeToWait = 5.0;
+
+	if ( !_inTurn && (_lastStanchionTimer.secsElapsed() > maxTimeToWait) ) {
+	    _crashed = true;
+	    cerr << "***ERROR*** Failed to find a stanchion in last "
+		 << maxTimeToWait << " seconds (frames: "
+		 << _fileData.frameCount
+		 << " last stanchion frame: " << _lastStanchionFrame
+		 << ")\n";
+	}
+    }
+}
+
+void Timon::exitTurn() {
+	_inTurn = false;
+	_lastStanchionTimer.start();
+}
+
+float Timon::getRelativeHeading(float initHeading) const {
+    float relHeading = _heading - initHeading;
+    // Put in range of [0, 360]
+    if (relHeading < 0) {
+        relHeading += 360;
+    }
+    // Now adjust to range of [-180.0, +180.0]
+    if (relHeading > 180) {
+        relHeading -= 360;
+    }
+    return relHeading;
+}
+
+Command::State Timon::doExecute() {
+    int64_t now = Clock::tickNanos();
+    _tickSecs = Timer::toSecs(now - _tickNanos);
+    _sensorTick.timeNanos = _tickNanos = now;
+    {
+        CommandProfiler::Scope scope("Timon.readSensors");
+        readSensors();
+    }
+    Command::State state;
+    if (hasCrashed()) {
+        // Make sure motors are turned off
+        coast();
+        // Catastrophic failure!
+        state = Command::INTERRUPTED;
+    } else {
+        state = CommandParallel::doExecute();
+    }
+
+    recordFlight();
+    recordSensors(SensorTick::EXECUTE, state);
+    return state;
+}
+
+void Timon::recordFlight() {
+    if (!_flight.isOpen()) {
+        return;
+    }
+
+    FlightRecord rec;
+    rec.timeNanos = TelemetryLog::nowNanos();
+    rec.lateNanos = (_tickTimer != 0) ? _tickTimer->getLastLateNanos() : 0;
+    rec.tick = (_tickTimer != 0) ? _tickTimer->getTicks() : 0;
+    rec.missed = (_tickTimer != 0) ? _tickTimer->getMissed() : 0;
+    rec.heading = _heading;
+    rec.left = _left.get();
+    rec.right = _right.get();
+    rec.crashed = _crashed;
+    rec.inTurn = _inTurn;
+    rec.reserved[0] = rec.reserved[1] = 0;
+    rec.vision = _fileData;
+    getActivePath(rec.path, FlightRecord::PATH_LEN);
+
+    _flight.add(rec);
+}
+
+void Timon::recordSensors(SensorTick::Kind kind, Command::State state) {
+    if (!_sensors.isOpen()) {
+        return;
+    }
+
+    SensorTick& tick = _sensorTick;
+    tick.tick = _sensors.getCount();
+    tick.kind = kind;
+    tick.state = state;
+    tick.left = _left.get();
+    tick.right = _right.get();
+    getActivePath(tick.path, SensorTick::PATH_LEN);
+
+    _sensors.add(tick);
+}
+
+void Timon::doEnd(Command::State reason) {
+    CommandParallel::doEnd(reason);
+    disable();
+
+    cout << "Vision frames lost (not read in time): " << _vision.getLostFrames() << "\n";
+    if (_telemetry.isOpen()) {
+        cout << "Telemetry records dropped: " << _telemetry.getDropped() << "\n";
+    }
+    cout << "Gyro failed reads: " << _gyro.getFailures()
+         << " (slowest read: " << (_gyro.getMaxReadNanos() / 1000) << " usecs)\n";
+    cout << "Left motor writes:\n";
+    _left.printWriteStats(cout);
+    cout << "Right motor writes:\n";
+    _right.printWriteStats(cout);
+
+    if (CommandProfiler::isEnabled()) {
+        CommandProfiler::dump(cout);
+        CommandProfiler::clear();
+    }
+}
+
+void Timon::disable() {
+    coast();
+}
+
+void Timon::nextWaypoint() {
+    // Let's use leds for reporting status now
+    //    UserLeds& leds = UserLeds::getInstance();
+    //    leds.setState(_wayPoint++);
+}
+
+float Timon::rangeCheckPower(float power) {
+    return max(-1.0f, min(+1.0f, power));
+}
+
+void Timon::record(const Command& cmd, TelemetryRecord::Kind kind,
+                   std::initializer_list<float> values) {
+    if (!_telemetry.isOpen()) {
+        return;
+    }
+
+    TelemetryRecord rec;
+    memset(&rec, 0, sizeof(rec));
+    rec.timeNanos = TelemetryLog::nowNanos();
+    rec.kind = kind;
+    // Record is zeroed, names of NAME_LEN characters are not nul terminated
+    const string& name = cmd.getName();
+    memcpy(rec.command, name.data(), min(name.size(), (size_t) TelemetryRecord::NAME_LEN));
+    rec.elapsed = cmd.getElapsedTime();
+    rec.left = _left.get();
+    rec.right = _right.get();
+    rec.heading = _heading;
+    rec.frameCount = _fileData.frameCount;
+    rec.found = _fileData.found;
+    rec.boxHeight = _fileData.boxHeight;
+    rec.inTurn = _inTurn;
+
+    for (initializer_list<float>::const_iterator it = values.begin();
+         (it != values.end()) && (rec.numValues < TelemetryRecord::MAX_VALUES); ++it) {
+        rec.values[rec.numValues++] = *it;
+    }
+
+    _telemetry.add(rec);
+}
+
+ostream& Timon::print(std::ostream& out, const Command& cmd) const {
+    out << cmd << "  Timon(left=" << _left.get() 
+	<< ", right=" << _right.get() << ", heading=" << _heading 
+	<< ", frameCount=" << _fileData.frameCount 
+	<< ", found=" << _fileData.found << ", box_height=" << _fileData.boxHeight 
+	<< ", inTurn=" << _inTurn << ")";
+    return out;
+}
+
+//
+// Implementation of the DriveToTurn class methods
+//
+
+DriveToTurn::DriveToTurn(Timon& car, float power, float timeout) :
+    Command("DriveToTurn", timeout),
+    _car(car),
+    _power(power),
+    _initialHeading(0)
+{
+}
+
+void DriveToTurn::doInitialize() {
+    _initialHeading = _car.getHeading();
+    _car.print(cout, *this) << "\n";
+}
+
+Command::State DriveToTurn::doExecute() {
+    float turned = _car.getRelativeHeading(_initialHeading);
+    float turnedMag = abs(turned);
+
+    float powerCorrect = 0;
+    if (turnedMag > 1.0) {
+        // TODO: Figure out a power correction (basically P of PID) based
+        // on how far turn is off
+        powerCorrect = turnedMag / 180 + 0.005;
+        powerCorrect = (turned > 0) ? powerCorrect : -powerCorrect;
+    }
+
+    float powerLeft = _power - powerCorrect;
+    float powerRight = _power + powerCorrect;
+
+    // Seek new drive power levels with power correction for steering
+    powerLeft = Timon::rangeCheckPower(powerLeft);
+    powerRight = Timon::rangeCheckPower(powerRight);
+    _car.seekDrive(powerLeft, powerRight);
+
+    bool foundCorner = _car.atCorner();
+
+    _car.record(*this, TelemetryRecord::DRIVE_TO_TURN, { turned, powerCorrect });
+    return (foundCorner ? Command::NORMAL_END : Command::STILL_RUNNING);
+}
+
+void DriveToTurn::doEnd(Command::State reason) {
+    _car.print(cout, *this) << "\n";
+    _car.nextWaypoint();
+}
+
+//
+// Implementation of the MakeTurn class methods
+//
+
+MakeTurn::MakeTurn(Timon& car, float turn) :
+    Command("MakeTurn", 1.0 + abs(turn) / 25),
+    _car(car),
+    _turn(turn),
+    _initialHeading(0),
+    _pid(),
+    _lastCarTurned(0),
+    _inRangeNanos(-1)
+{
+}
+
+MakeTurn::~MakeTurn() { 
+}
+
+void MakeTurn::doInitialize() {
+    _car.print(cout, *this) << "MAKING TURN\n";
+    _car.enterTurn();
+
+    _initialHeading = _car.getHeading();
+    _lastCarTurned = 0;
+    _inRangeNanos = -1;
+
+    // The D term has always added the rate the error shrinks (leads the
+    // turn rather than damping it), keep that sign so turnD still applies
+    const TimonTuning& tuning = _car.getTuning();
+    _pid.setGains(tuning.turnP, 0, -tuning.turnD);
+    _pid.setDerivativeFilter(tuning.derivFilterSecs);
+    // Limit maximum range
+    _pid.setOutputLimit(tuning.turnMaxMag);
+    _pid.reset();
+}
+
+Command::State MakeTurn::doExecute() {
+    float carTurned = _car.getRelativeHeading(_initialHeading);
+    float err = _turn - carTurned;
+    const TimonTuning& tuning = _car.getTuning();
+
+    float steer = _pid.update(err, _car.getTickNanos());
+    const float maxMag = tuning.turnMaxMag;
+
+    // Then shift to minimum power level
+    // float steerMag = abs(steer);
+    //const float minMag = 0.15f;
+    //steer = (steer < 0) ? steer - minMag : steer + minMag;
+    
+    // Use full power while the car is barely turning (was 0.4 degrees
+    // per 20 Hz tick)
+    const float stalledDegPerSec = 8.0;
+    float minMag = tuning.turnBaseMinMag;
+    if (abs(carTurned - _lastCarTurned) < stalledDegPerSec * _car.getTickSecs()) {
+		minMag = maxMag;
+    } 
+    
+    if (steer > -minMag && steer < minMag) {
+		steer = (steer < 0) ? -minMag : minMag;
+    }
+  
+    steer = Timon::rangeCheckPower(steer);
+    _car.drive(steer, -steer);
+
+    // TODO: NOTE, this implementation does not take into account a minimum
+    // power to turn the car (for example, if we get within 10 degrees and
+    // drop the power too low, the car may stop turning and never reach
+    // the final target).
+
+    _car.record(*this, TelemetryRecord::MAKE_TURN, { carTurned, err, steer });
+
+    // Done once within 6 degrees for a tick's worth of time (two
+    // readings in a row at 20 Hz)
+    const int64_t settleNanos = 40000000;
+    int64_t now = _car.getTickNanos();
+    if (abs(err) >= 6.0) {
+        _inRangeNanos = -1;
+    } else if (_inRangeNanos < 0) {
+        _inRangeNanos = now;
+    }
+
+    _lastCarTurned = carTurned;
+    bool settled = (_inRangeNanos >= 0) && (now - _inRangeNanos >= settleNanos);
+    return (settled ? Command::NORMAL_END : Command::STILL_RUNNING);
+}
+
+void MakeTurn::doEnd(Command::State reason) {
+    _car.print(cout, *this) << "\n";
+    _car.exitTurn();
+}
+
+//
+// Implementation of the MakeSmoothTurn class methods
+//
+
+MakeSmoothTurn::MakeSmoothTurn(Timon& car, float turn) :
+    Command("MakeSmoothTurn", 1.0 + abs(turn) / 25),
+    _car(car),
+    _turn(turn),
+    _initialHeading(0),
+    _lastErr(0),
+    _inRangeCnt(0)
+{
+}
+
+MakeSmoothTurn::~MakeSmoothTurn() { 
+}
+
+void MakeSmoothTurn::doInitialize() {
+    _car.print(cout, *this) << "\n";
+    _initialHeading = _car.getHeading();
+    _lastErr = _turn;
+    _inRangeCnt = 0;
+}
+
+Command::State MakeSmoothTurn::doExecute() {
+    float carTurned = _car.getRelativeHeading(_initialHeading);
+
+    _car.drive(.25, .2);
+
+    _car.record(*this, TelemetryRecord::MAKE_SMOOTH_TURN, { carTurned });
+
+    return ((abs(carTurned) >= abs(_turn)) ? Command::NORMAL_END : Command::STILL_RUNNING);
+}
+
+void MakeSmoothTurn::doEnd(Command::State reason) {
+    _car.print(cout, *this) << "\n";
+}
+
+//
+// Implementation of the DrivePowerTime class methods
+//
+
+DrivePowerTime::DrivePowerTime(Timon& car, float powerLeft, float powerRight,
+                               float howLong) :
+    Command("DrivePowerTime", howLong + 1.0),
+    _car(car),
+    _powerLeft(powerLeft),
+    _powerRight(powerRight),
+    _runTime(howLong)
+{
+}
+
+DrivePowerTime::~DrivePowerTime() { 
+}
+
+Command::State DrivePowerTime::doExecute() {
+    if (getElapsedTime() >= _runTime) {
+        return Command::NORMAL_END;
+    }
+
+    _car.drive(_powerLeft, _powerRight);
+    _car.record(*this, TelemetryRecord::TICK);
+
+    return Command::STILL_RUNNING;
+}
+
+void DrivePowerTime::doEnd(Command::State reason) {
+    // If command was to bring car to a stop and the 
+    if (reason == Command::NORMAL_END) {
+        if (_powerLeft == 0 && _powerRight == 0) {
+            _car.drive(0, 0);
+        }
+    }
+}
+
+//
+// Implementation of the StatusLeds class methods
+//
+
+StatusLeds::StatusLeds(Timon& car, float period) :
+    // Runs until the drive commands are done
+    Command("StatusLeds", 3600),
+    _car(car)
+{
+    setPeriod(period);
+}
+
+Command::State StatusLeds::doExecute() {
+    int ledsState = 0;
+    const FileData& fileData = _car.getFileData();
+
+    if (fileData.found == Found::Yellow) {
+	// Light 4th LED if yellow found (next to Ethernet)
+	ledsState |= 0x8;
+    } else if (fileData.found == Found::Red) {
+	// Light 3rd LED if red found
+	ledsState |= 0x4;
+    }
+    if ((fileData.boxHeight >= 80) && (fileData.boxHeight <= 120)) {
+	// Light 1st LED if last height was within range
+	ledsState |= 0x1;
+    }
+
+    Hal::Leds& leds = Hal::Leds::getInstance();
+    leds.setState(ledsState);
+
+    return Command::STILL_RUNNING;
+}
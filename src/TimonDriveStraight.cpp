@@ -7,11 +7,6 @@
 using namespace avc;
 using namespace std;
 
-const float DriveStraight::DRIVE_POWER = 0.15;
-const float DriveStraight::MAX_DRIVE_POWER = DRIVE_POWER * 1.5;
-const float DriveStraight::P = 0.04;
-const float DriveStraight::D = 0.025;
-
 DriveStraight::DriveStraight(Timon& car, float heading, float minTime, bool relative) :
     Command("DriveStraight", 3600),
     _car(car),
@@ -20,7 +15,7 @@ DriveStraight::DriveStraight(Timon& car, float heading, float minTime, bool rela
 	_headingCorrection(0),
     _leftPower(0),
     _rightPower(0),
-    _lastAngErr(0),
+    _pid(),
     _lastHeadingCorrection(0),
     _minTimeToDrive(minTime),
     _relative(relative)
@@ -41,16 +36,20 @@ void DriveStraight::doInitialize() {
   } else {
 	_desiredHeading = _heading;
   }
-    // Hmmmm, should we compute last angle error or just init to 0?
-    _lastAngErr = 0;
+    const TimonTuning& tuning = _car.getTuning();
+    _pid.setGains(tuning.straightP, 0, tuning.straightD);
+    _pid.setDerivativeFilter(tuning.derivFilterSecs);
+    _pid.reset();
     
-    _rightPower = _leftPower = DRIVE_POWER;
+    _rightPower = _leftPower = _car.getTuning().drivePower;
 
 	resetCounts();
 }
 
 Command::State DriveStraight::doExecute() {
     float curHeading = _car.getHeading();
+    const TimonTuning& tuning = _car.getTuning();
+    const float maxDrivePower = tuning.drivePower * tuning.maxDriveRatio;
 
     FileData& fileData = _car.getFileData();
 
@@ -85,43 +84,34 @@ Command::State DriveStraight::doExecute() {
     _headingCorrection = max(min(_headingCorrection, maxCorrection), -maxCorrection);
 
     float angErr = computeAngDiff(_desiredHeading + _headingCorrection, curHeading);
-    float angErrChange = angErr - _lastAngErr;
 
     // Compute a % adjustment to power to "correct" for turn
-    float adjPower = P * angErr + D * angErrChange;
+    float adjPower = _pid.update(angErr, _car.getTickNanos());
     
     //_rightPower = _rightPower * (1 - adjPower);
     //_leftPower = _leftPower * (1 + adjPower);
 
 	// NOTE PLUS AND MINUS ARE REVERESED HERE.
-    _rightPower = DRIVE_POWER * (1 - adjPower);
-    _leftPower = DRIVE_POWER * (1 + adjPower);
+    _rightPower = tuning.drivePower * (1 - adjPower);
+    _leftPower = tuning.drivePower * (1 + adjPower);
 
     // TODO: We should adjust power based on how far/near to the
     // side we are as well (need red stanchion info)
 
     // Don't let power get too high
-    _rightPower = min(_rightPower, MAX_DRIVE_POWER);
-    _leftPower = min(_leftPower, MAX_DRIVE_POWER);
-
-    _car.print(cout, *this) << "\n  desiredHeading: " << _desiredHeading
-							<< "  heading: " << curHeading
-							<< "  angErr: " << angErr
-							<< "  left: " << _leftPower
-							<< "  right: " << _rightPower
-                            << "  redCnt: " << getRedCount()
-                            << "  yelCnt: " << getYellowCount()
-							<< "  correction:  " << _headingCorrection
-                            << "\n";
+    _rightPower = min(_rightPower, maxDrivePower);
+    _leftPower = min(_leftPower, maxDrivePower);
+
+    _car.record(*this, TelemetryRecord::DRIVE_STRAIGHT,
+                { _desiredHeading, curHeading, angErr, _leftPower, _rightPower,
+                  (float) getRedCount(), (float) getYellowCount(), _headingCorrection });
 
     _car.drive(_leftPower, _rightPower);
 
-    _lastAngErr = angErr;
 	_lastHeadingCorrection = _headingCorrection;
 
     if (getElapsedTime() < _minTimeToDrive) {
 		resetCounts();
-		_car.print(cout, *this) << "\nResetting counts to zero" << "\n";
 
 		return Command::STILL_RUNNING;
     }
@@ -9,6 +9,7 @@
 #include "Timon.h"
 #endif
 
+#include "Pid.h"
 #include "Timer.h"
 
 namespace avc {
@@ -61,14 +62,6 @@ namespace avc {
 		_initialYellow = _car.getCounter(Found::Yellow);
 	}
  
-	// Constant values
-	static const float DRIVE_POWER;
-	static const float MAX_DRIVE_POWER;
-
-	// PID values (no I)
-	static const float P;
-	static const float D;
-
 	// Member variables
         Timon& _car;
 	float _heading;
@@ -77,7 +70,7 @@ namespace avc {
 
 	float _leftPower;
 	float _rightPower;
-	float _lastAngErr;
+	Pid _pid;
 	float _minTimeToDrive;
 	bool _relative;
 
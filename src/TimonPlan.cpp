@@ -0,0 +1,130 @@
+/**
+ * Implementation of the PlanExecutor class.
+ */
+
+#include "TimonPlan.h"
+
+#include <iostream>
+#include <new>
+
+using namespace avc;
+using namespace std;
+
+PlanExecutor::PlanExecutor(Timon& car, const AutonPlan& plan) :
+    Command("Plan"),
+    _car(car),
+    _plan(plan),
+    _index(0),
+    _active(0)
+{
+    // Same as a CommandSequence, the timeout is the sum of the steps
+    float timeout = 0;
+    for (uint32_t i = 0; i < _plan.count; i++) {
+        timeout += startStep(_plan.steps[i])->getTimeout();
+        finishStep();
+    }
+    setTimeout(timeout);
+}
+
+PlanExecutor::~PlanExecutor() {
+    finishStep();
+}
+
+Command* PlanExecutor::startStep(const PlanStep& step) {
+    const float* args = step.args;
+    void* where = &_storage;
+
+    switch (step.op) {
+    case PlanStep::DRIVE_POWER_TIME:
+        _active = new (where) DrivePowerTime(_car, args[0], args[1], args[2]);
+        break;
+
+    case PlanStep::DRIVE_STRAIGHT:
+        _active = new (where) DriveStraight(_car, args[0], args[1],
+                                            (step.flags & PlanStep::RELATIVE) != 0);
+        break;
+
+    case PlanStep::BRAKE:
+        _active = new (where) Brake(_car, args[0]);
+        break;
+
+    case PlanStep::MAKE_TURN:
+        _active = new (where) MakeTurn(_car, args[0]);
+        break;
+
+    case PlanStep::MAKE_SMOOTH_TURN:
+        _active = new (where) MakeSmoothTurn(_car, args[0]);
+        break;
+
+    case PlanStep::DRIVE_TO_TURN:
+        _active = new (where) DriveToTurn(_car, args[0], args[1]);
+        break;
+
+    default:
+        // Plans are validated when loaded, stop the car if one slips through
+        cerr << "***ERROR*** Unknown plan step " << (int) step.op << ", stopping\n";
+        _active = new (where) DrivePowerTime(_car, 0, 0, 0);
+        break;
+    }
+    return _active;
+}
+
+void PlanExecutor::finishStep() {
+    if (_active != 0) {
+        _active->~Command();
+        _active = 0;
+    }
+}
+
+void PlanExecutor::doInitialize() {
+    finishStep();
+    _index = 0;
+}
+
+Command::State PlanExecutor::doExecute() {
+    State state = Command::NORMAL_END;
+    int n = _plan.count;
+
+    while (_index < n) {
+        if (_active == 0) {
+            startStep(_plan.steps[_index])->initialize();
+            cout << "Seq initialized: " << *this << "\n";
+        }
+
+        state = _active->execute();
+        if (state == Command::STILL_RUNNING) {
+            break;
+        }
+        _active->end(state);
+        cout << "Seq ended: " << *this << "\n";
+        finishStep();
+
+        if (state != Command::NORMAL_END) {
+            // Don't start any more steps
+            _index = n;
+            break;
+        }
+
+        // Step ended normally, move to next step in plan
+        _index++;
+    }
+    return state;
+}
+
+void PlanExecutor::doEnd(Command::State reason) {
+    if (_active != 0) {
+        // If we had a step running, then end it
+        _active->end(reason);
+        finishStep();
+    }
+    // Move index past end so we don't start any new steps
+    _index = _plan.count;
+}
+
+ostream& PlanExecutor::print(ostream& out) const {
+    out << getName() << '[' << _index << " of " << _plan.count << "]";
+    if (_active != 0) {
+        out << " = " << *_active;
+    }
+    return out;
+}
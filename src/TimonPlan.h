@@ -0,0 +1,82 @@
+/**
+ * Definition of the PlanExecutor class (runs a compiled AutonPlan on
+ * Timon).
+ */
+#ifndef __avc_TimonPlan_h
+#define __avc_TimonPlan_h
+
+#include "AutonPlan.h"
+#include "Brake.h"
+#include "TimonDriveStraight.h"
+
+#include <type_traits>
+
+namespace avc {
+
+    /**
+     * Command which runs the steps of an AutonPlan one after the other
+     * (like a CommandSequence built from the plan).
+     *
+     * <p>The plan is a flat table, so instead of building a tree of
+     * commands the executor constructs the command of the current step
+     * in place (in storage big enough for any step), runs it and
+     * destroys it before moving on. Loading a plan never touches the
+     * heap and nothing is built for steps that are never reached.</p>
+     */
+    class PlanExecutor : public Command {
+
+    public:
+        /**
+         * Constructs the executor (the plan is copied, it must already
+         * be valid - see AutonPlan::validate).
+         *
+         * @param car The car to run the steps on.
+         * @param plan The steps to run.
+         */
+        PlanExecutor(Timon& car, const AutonPlan& plan);
+
+        ~PlanExecutor();
+
+        void doInitialize();
+
+        Command::State doExecute();
+
+        void doEnd(Command::State reason);
+
+        const Command* getActiveChild() const { return _active; }
+
+        /** The steps being run. */
+        const AutonPlan& getPlan() const { return _plan; }
+
+        std::ostream& print(std::ostream& out) const;
+
+    private:
+        PlanExecutor(const PlanExecutor&);
+
+        // Constructs the command of a step in _storage
+        Command* startStep(const PlanStep& step);
+
+        // Destroys the command of the current step
+        void finishStep();
+
+        Timon& _car;
+        AutonPlan _plan;
+        int _index;
+        Command* _active;
+
+        // Room for the command of any step (built in place by startStep)
+        template <class T> struct Slot {
+            typedef typename std::aligned_storage<sizeof(T), std::alignment_of<T>::value>::type type;
+        };
+        union {
+            Slot<DrivePowerTime>::type _drivePowerTime;
+            Slot<DriveStraight>::type _driveStraight;
+            Slot<Brake>::type _brake;
+            Slot<MakeTurn>::type _makeTurn;
+            Slot<MakeSmoothTurn>::type _makeSmoothTurn;
+            Slot<DriveToTurn>::type _driveToTurn;
+        } _storage;
+    };
+}
+
+#endif
@@ -4,8 +4,11 @@
 
 #include "UserLeds.h"
 
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
 #include <iostream>
-#include <fstream>
+#include <system_error>
 
 using namespace avc;
 using namespace std;
@@ -22,29 +25,23 @@ namespace {
     return ((bits >> bit) & 1) == 1;
   }
 
-  inline void setBit(int& bits, int bit) {
-    bits |= (1 << bit);
-  }
+  // Trigger names (indexed by UserLeds::Trigger)
+  const char* triggerNames[] = { "", "none", "timer", "oneshot" };
 
-  inline void clearBit(int& bits, int bit) {
-    bits &= ~(1 << bit);
+  // Writes a millisecond value to an attribute the trigger created
+  bool writeMillis(const string& path, int millis) {
+    char value[16];
+    int len = snprintf(value, sizeof(value), "%d", millis);
+    SysfsFile file;
+    return file.open(path) && file.write(value, len);
   }
 
-  bool writeSysFile(int led, const string& fileName, const string& value) {
-    if (!isLedOk(led)) {
-      return false;
-    }
-
+  string sysPath(int led, const char* fileName) {
     string path(SYS_PATH_PREFIX);
     path += ledToChar[led];
     path += '/';
     path += fileName;
-
-    ofstream out(path, std::ofstream::out);
-    bool ok = out.write(value.c_str(), value.size());
-    out.close();
-
-    return ok;
+    return path;
   }
 }
 
@@ -52,53 +49,254 @@ namespace {
 UserLeds UserLeds::instance;
 
 UserLeds::UserLeds() :
-  initialized(0),
-  state(0) {
+  initialized(false),
+  initOk(false),
+  state(0),
+  written(-1),
+  pattern(NONE),
+  periodMillis(0),
+  writtenPattern(NONE),
+  writtenPeriodMillis(0),
+  flashLeds(0),
+  flashMillis(0),
+  stopWriter(false),
+  mutex(),
+  changed(),
+  writer() {
+  for (int led = 0; led < 4; led++) {
+    triggers[led] = TRIGGER_UNKNOWN;
+  }
 }
 
-bool UserLeds::setState(int newState) {
-  bool ok = true;
-  for (int i = 0; i < 4; i++) {
-    ok = ok && setLed(i, (newState & 1) == 1);
-    newState >>= 1;
+UserLeds::~UserLeds() {
+  {
+    lock_guard<std::mutex> lock(mutex);
+    stopWriter = true;
+  }
+  changed.notify_all();
+  if (writer.joinable()) {
+    writer.join();
   }
+}
+
+bool UserLeds::initialize() {
+  if (initialized) {
+    return initOk;
+  }
+  initialized = true;
+  initOk = true;
+
+  for (int led = 0; led < 4; led++) {
+    // Take control of user LED
+    initOk = triggerFiles[led].open(sysPath(led, "trigger")) && setTrigger(led, TRIGGER_NONE) &&
+      brightness[led].open(sysPath(led, "brightness")) && initOk;
+  }
+
+  if (!initOk) {
+    cerr << "WARNING: Unable to take control of user LEDs (" << SYS_PATH_PREFIX << "N)\n";
+  }
+
+  try {
+    writer = thread(&UserLeds::run, this);
+  } catch (const system_error& e) {
+    cerr << "***ERROR*** Unable to start LED writer thread: " << e.what() << "\n";
+    initOk = false;
+  }
+  return initOk;
+}
+
+bool UserLeds::setState(int newState) {
+  lock_guard<std::mutex> lock(mutex);
+  bool ok = initialize();
+  newState &= 0xf;
 
+  if (ok && ((newState != state) || (pattern != NONE))) {
+    state = newState;
+    pattern = NONE;
+    changed.notify_all();
+  }
   return ok;
 }
 
+int UserLeds::getState() const {
+  lock_guard<std::mutex> lock(mutex);
+  return state;
+}
+
 bool UserLeds::setLed(int led, bool turnOn) {
-  bool ok = isLedOk(led);
-  if (ok) {
-    bool force = false;
-
-    // See if we still need to initialize
-    if (isBitSet(initialized, led) == false) {
-      setBit(initialized, led);
-      // Take control of user LED
-      ok = writeSysFile(led, "trigger", "none");
-      force = true;
-    }
+  if (!isLedOk(led)) {
+    return false;
+  }
 
-    // See if we need to update the system file
-    if (ok && (force || (isBitSet(state, led) != turnOn))) {
-      string fileName("brightness");
+  lock_guard<std::mutex> lock(mutex);
+  bool ok = initialize();
+  int newState = (turnOn ? (state | (1 << led)) : (state & ~(1 << led)));
 
-      if (turnOn) {
-	      setBit(state, led);
-	      ok = writeSysFile(led, fileName, "1");
-      } else {
-	      clearBit(state, led);
-	      ok = writeSysFile(led, fileName, "0");
-      }
-    }
+  if (ok && ((newState != state) || (pattern != NONE))) {
+    state = newState;
+    pattern = NONE;
+    changed.notify_all();
   }
   return ok;
 }
 
-
 bool UserLeds::isLedOn(int led) const {
+  lock_guard<std::mutex> lock(mutex);
   bool on = isLedOk(led) && isBitSet(state, led);
   return on;
 }
 
+bool UserLeds::setPattern(Pattern newPattern, int newPeriodMillis) {
+  lock_guard<std::mutex> lock(mutex);
+  bool ok = initialize() && (newPeriodMillis >= 4);
 
+  if (ok && ((newPattern != pattern) || (newPeriodMillis != periodMillis))) {
+    pattern = newPattern;
+    periodMillis = newPeriodMillis;
+    changed.notify_all();
+  }
+  return ok;
+}
+
+UserLeds::Pattern UserLeds::getPattern() const {
+  lock_guard<std::mutex> lock(mutex);
+  return pattern;
+}
+
+bool UserLeds::flash(int leds, int onMillis) {
+  lock_guard<std::mutex> lock(mutex);
+  bool ok = initialize() && (onMillis > 0);
+
+  if (ok && ((leds & 0xf) != 0)) {
+    // LEDs are left off once the flash is over
+    pattern = NONE;
+    state &= ~leds;
+    flashLeds |= (leds & 0xf);
+    flashMillis = onMillis;
+    changed.notify_all();
+  }
+  return ok;
+}
+
+void UserLeds::flush() {
+  unique_lock<std::mutex> lock(mutex);
+  while (initOk && writer.joinable() && hasWork()) {
+    changed.wait(lock);
+  }
+}
+
+bool UserLeds::hasWork() const {
+  bool work = (pattern == NONE) ? (written != state) :
+    ((pattern != writtenPattern) || (periodMillis != writtenPeriodMillis));
+  return work || (flashLeds != 0);
+}
+
+bool UserLeds::setTrigger(int led, Trigger trigger) {
+  if (triggers[led] == trigger) {
+    return true;
+  }
+  bool ok = triggerFiles[led].write(triggerNames[trigger]);
+  triggers[led] = (ok ? trigger : TRIGGER_UNKNOWN);
+  return ok;
+}
+
+bool UserLeds::startPattern(Pattern newPattern, int period,
+			    unique_lock<std::mutex>& lock) {
+  int onMillis = period / 2;
+  // How long to wait before starting the next LED
+  int staggerMillis = 0;
+
+  if (newPattern == CHASE) {
+    onMillis = period / 4;
+    staggerMillis = onMillis;
+  } else if (newPattern == HEARTBEAT) {
+    onMillis = max(1, min(100, period / 10));
+  }
+
+  for (int led = 0; led < 4; led++) {
+    if ((led > 0) && (staggerMillis > 0)) {
+      // Wait to start next LED, but give up if a new request comes in
+      lock.lock();
+      bool interrupted = changed.wait_for(lock, chrono::milliseconds(staggerMillis), [&] {
+	  return stopWriter || (pattern != newPattern) || (periodMillis != period);
+	});
+      lock.unlock();
+      if (interrupted) {
+	return false;
+      }
+    }
+
+    // Each write of delay_on/delay_off restarts the cycle (LED on)
+    setTrigger(led, TRIGGER_TIMER);
+    writeMillis(sysPath(led, "delay_on"), onMillis);
+    writeMillis(sysPath(led, "delay_off"), period - onMillis);
+  }
+  return true;
+}
+
+void UserLeds::startFlash(int leds, int onMillis) {
+  for (int led = 0; led < 4; led++) {
+    if (isBitSet(leds, led) && setTrigger(led, TRIGGER_ONESHOT)) {
+      writeMillis(sysPath(led, "delay_on"), onMillis);
+      writeMillis(sysPath(led, "delay_off"), 1);
+      SysfsFile shot;
+      if (shot.open(sysPath(led, "shot"))) {
+	shot.write("1", 1);
+      }
+    }
+  }
+}
+
+void UserLeds::run() {
+  unique_lock<std::mutex> lock(mutex);
+
+  while (true) {
+    while (!hasWork() && !stopWriter) {
+      changed.wait(lock);
+    }
+    if (!hasWork()) {
+      break;
+    }
+
+    // Write without holding the lock (changes made meanwhile are
+    // picked up on the next pass)
+    Pattern targetPattern = pattern;
+    int targetPeriod = periodMillis;
+    int target = state;
+    int prior = written;
+    int flashNow = flashLeds;
+    int flashNowMillis = flashMillis;
+    flashLeds = 0;
+    bool newPattern = (targetPattern != writtenPattern) || (targetPeriod != writtenPeriodMillis);
+    lock.unlock();
+
+    bool done = true;
+    if (targetPattern != NONE) {
+      done = (newPattern == false) || startPattern(targetPattern, targetPeriod, lock);
+    } else {
+      for (int led = 0; led < 4; led++) {
+	bool on = isBitSet(target, led);
+	// Removing a trigger turns the LED off, so always rewrite it
+	bool force = (triggers[led] != TRIGGER_NONE);
+	if (force) {
+	  setTrigger(led, TRIGGER_NONE);
+	}
+	if (force || (prior < 0) || (isBitSet(prior, led) != on)) {
+	  brightness[led].write(on ? "1" : "0", 1);
+	}
+      }
+    }
+
+    if (flashNow != 0) {
+      startFlash(flashNow, flashNowMillis);
+    }
+
+    lock.lock();
+    if (done) {
+      writtenPattern = targetPattern;
+      writtenPeriodMillis = targetPeriod;
+      written = (targetPattern == NONE) ? target : -1;
+    }
+    changed.notify_all();
+  }
+}
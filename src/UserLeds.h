@@ -4,7 +4,12 @@
 #ifndef __avc_UserLeds_h
 #define __avc_UserLeds_h
 
+#include "SysfsFile.h"
+
+#include <condition_variable>
 #include <iostream>
+#include <mutex>
+#include <thread>
 
 #include <time.h>
 
@@ -12,10 +17,38 @@ namespace avc {
 
   /**
    * UserLeds is a singleton used to control the 4 onboard LEDs on a BBB.
+   *
+   * <p>The four "brightness" files are opened once and the actual
+   * writes are made by a background thread, so changing LEDs never
+   * adds file I/O to the caller (like the control loop). Setting a
+   * state that is already pending costs nothing and several changes
+   * made before the writer gets to them are coalesced into one write
+   * per LED that really changed.</p>
+   *
+   * <p>Animated patterns are handed off to the kernel "timer" LED
+   * trigger (and single flashes to the "oneshot" trigger), so once a
+   * pattern is started neither this process nor the writer thread
+   * needs to wake up to animate it.</p>
    */
   class UserLeds {
 
   public:
+    /**
+     * Patterns the kernel can animate on its own (see {@link #setPattern}).
+     */
+    enum Pattern {
+      /** No pattern, LEDs are set by setState() and setLed(). */
+      NONE = 0,
+
+      /** All four LEDs blink on and off together. */
+      BLINK = 1,
+
+      /** One LED at a time is lit moving from USER0 to USER3. */
+      CHASE = 2,
+
+      /** All four LEDs give a short flash once per period. */
+      HEARTBEAT = 3
+    };
 
     /**
      * Get access to the single instance of the object used to
@@ -28,14 +61,16 @@ namespace avc {
      *
      * @param newState - Low bit goes with USER0, 0xf all on, 0x0 all off.
      *
-     * @return true if successfully set state, false if file permission issue.
+     * @return true if the new state was accepted, false if the LED
+     * files could not be opened (file permission issue).
      */
     bool setState(int newState);
 
     /**
-     * Return the last state set on ALL four LEDs in a single shot.
+     * Return the last state set on ALL four LEDs in a single shot
+     * (which may not have been written out yet).
      */
-    int getState() const { return state; }
+    int getState() const;
 
     /**
      * Set the state of a specific LED.
@@ -43,7 +78,7 @@ namespace avc {
      * @param led The LED to modify in the range: [0, 3].
      * @param turnOn Pass true to turn on, false to turn off.
      *
-     * @return true if successfully set state, false if file
+     * @return true if the new state was accepted, false if file
      * permission issue or out of range led value passed.
      */
     bool setLed(int led, bool turnOn);
@@ -57,19 +92,118 @@ namespace avc {
      */
     bool isLedOn(int led) const;
 
+    /**
+     * Starts an animated pattern using the kernel LED timer trigger.
+     *
+     * <p>The pattern runs until a different pattern is selected or
+     * {@link #setState} or {@link #setLed} is called (which stop the
+     * pattern and put all of the LEDs back under our control).</p>
+     *
+     * @param pattern The pattern to display.
+     *
+     * @param periodMillis How long one cycle of the pattern takes
+     * (in milliseconds).
+     *
+     * @return true if the pattern was accepted, false if the LED
+     * files could not be opened.
+     */
+    bool setPattern(Pattern pattern, int periodMillis = 1000);
+
+    /**
+     * Returns the pattern last selected (NONE if LEDs are being set
+     * directly).
+     */
+    Pattern getPattern() const;
+
+    /**
+     * Flashes LEDs on once using the kernel oneshot trigger (stops any
+     * running pattern).
+     *
+     * @param leds Bit mask of LEDs to flash (low bit goes with USER0).
+     *
+     * @param onMillis How long the LEDs stay on (in milliseconds).
+     *
+     * @return true if the flash was accepted.
+     */
+    bool flash(int leds, int onMillis);
+
+    /**
+     * Waits until the last state set has been written out to the LEDs.
+     */
+    void flush();
+
   private:
+    // Trigger last written to an LED
+    enum Trigger {
+      TRIGGER_UNKNOWN,
+      TRIGGER_NONE,
+      TRIGGER_TIMER,
+      TRIGGER_ONESHOT
+    };
     // Hide constructors (force use of getInstance)
     UserLeds();
     UserLeds(const UserLeds&);
 
+    // Writes out any pending state then stops the writer thread
+    ~UserLeds();
+
+    // Opens LED files and starts writer thread (caller holds mutex)
+    bool initialize();
+
+    // Entry point of the writer thread
+    void run();
+
+    // Returns true if writer thread has something to do (caller holds mutex)
+    bool hasWork() const;
+
+    // Writes the trigger of an LED (if different than last written)
+    bool setTrigger(int led, Trigger trigger);
+
+    // Sets up kernel triggers for a pattern (called by writer thread
+    // without the lock, returns false if interrupted by a new request)
+    bool startPattern(Pattern pattern, int periodMillis,
+		      std::unique_lock<std::mutex>& lock);
+
+    // Fires the oneshot trigger on the LEDs in the mask
+    void startFlash(int leds, int onMillis);
+
     // Single instance of object
     static UserLeds instance;
 
-    // Whether or not the LED has been initialized
-    int initialized;
+    // Whether or not we've tried to initialize (and if that worked)
+    bool initialized;
+    bool initOk;
 
-    // Current state of USER LEDs2
+    // Desired state of USER LEDs
     int state;
+
+    // State last written to USER LEDs (-1 if unknown)
+    int written;
+
+    // Desired pattern and pattern last started by writer thread
+    Pattern pattern;
+    int periodMillis;
+    Pattern writtenPattern;
+    int writtenPeriodMillis;
+
+    // LEDs waiting to be flashed and how long to flash them
+    int flashLeds;
+    int flashMillis;
+
+    // Trigger last written to each LED (only used by writer thread)
+    Trigger triggers[4];
+
+    // Tells writer thread to exit once everything is written
+    bool stopWriter;
+
+    // Open trigger and brightness file of each LED
+    SysfsFile triggerFiles[4];
+    SysfsFile brightness[4];
+
+    // Protects the states above and wakes the writer/flush callers
+    mutable std::mutex mutex;
+    std::condition_variable changed;
+    std::thread writer;
   };
 
 }
@@ -0,0 +1,181 @@
+/**
+ * Implementation of the VisionReader class.
+ */
+
+#include "VisionReader.h"
+
+#include <iostream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace avc;
+using namespace std;
+
+namespace {
+  // How many times to retry if we catch the writer mid update
+  const int maxAttempts = 1000;
+
+  inline void cpuRelax() {
+#if defined(__i386__) || defined(__x86_64__)
+    __builtin_ia32_pause();
+#else
+    __asm__ __volatile__("" ::: "memory");
+#endif
+  }
+}
+
+VisionReader::VisionReader() :
+  _mem(0),
+  _memSize(0),
+  _latest(0),
+  _ring(0),
+  _tail(0),
+  _lost(0),
+  _lastFrameCount(0),
+  _haveLast(false)
+{
+}
+
+VisionReader::~VisionReader() {
+  close();
+}
+
+bool VisionReader::open(const string& path) {
+  close();
+
+  int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    cerr << "***ERROR*** Unable to open vision file: " << path << "\n";
+    return false;
+  }
+
+  struct stat info;
+  if ((fstat(fd, &info) != 0) || (info.st_size < (off_t) sizeof(FileData))) {
+    cerr << "***ERROR*** Vision file too small: " << path << "\n";
+    ::close(fd);
+    return false;
+  }
+
+  bool ringFits = (info.st_size >= (off_t) sizeof(VisionRing));
+  size_t size = ringFits ? sizeof(VisionRing) : sizeof(FileData);
+  void* mem = mmap(0, size, PROT_READ, MAP_SHARED, fd, 0);
+  // Mapping remains valid after the file descriptor is closed
+  ::close(fd);
+
+  if (mem == MAP_FAILED) {
+    cerr << "***ERROR*** Unable to map vision file: " << path << "\n";
+    return false;
+  }
+
+  _mem = mem;
+  _memSize = size;
+  _latest = static_cast<const FileData*>(mem);
+  _ring = ringFits ? static_cast<const VisionRing*>(mem) : 0;
+  skipToLatest();
+  return true;
+}
+
+void VisionReader::close() {
+  if (_mem != 0) {
+    munmap(_mem, _memSize);
+  }
+  _mem = 0;
+  _memSize = 0;
+  _latest = 0;
+  _ring = 0;
+}
+
+bool VisionReader::read(FileData& data) const {
+  if (_latest == 0) {
+    return false;
+  }
+
+  for (int i = 0; i < maxAttempts; i++) {
+    // Writer stores safetyFrameCount last (release), so once we see
+    // it, the payload stored before it is visible
+    int safety = __atomic_load_n(&_latest->safetyFrameCount, __ATOMIC_ACQUIRE);
+
+    FileData copy;
+    memcpy(&copy, (const void*) _latest, sizeof(copy));
+
+    // Keep payload loads from moving after the frameCount load
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    int frame = __atomic_load_n(&_latest->frameCount, __ATOMIC_RELAXED);
+
+    if (frame == safety) {
+      copy.frameCount = frame;
+      copy.safetyFrameCount = safety;
+      data = copy;
+      return true;
+    }
+    cpuRelax();
+  }
+  return false;
+}
+
+int VisionReader::drain(VisionFrame* frames, int maxFrames) {
+  bool useRing = (_ring != 0) &&
+    (__atomic_load_n(&_ring->magic, __ATOMIC_ACQUIRE) == VisionRing::MAGIC);
+
+  if (!useRing) {
+    FileData data;
+    if (!read(data)) {
+      return -1;
+    }
+    if ((maxFrames < 1) || (_haveLast && (data.frameCount == _lastFrameCount))) {
+      return 0;
+    }
+    _haveLast = true;
+    _lastFrameCount = data.frameCount;
+    frames[0].timeNanos = 0;
+    frames[0].data = data;
+    return 1;
+  }
+
+  uint32_t head = __atomic_load_n(&_ring->head, __ATOMIC_ACQUIRE);
+  uint32_t behind = head - _tail;
+
+  if (behind > (uint32_t) (1u << 31)) {
+    // Head went backwards (writer restarted), start over at latest
+    _tail = (head > 0) ? head - 1 : 0;
+  } else if (behind > VisionRing::CAPACITY) {
+    // Oldest frames were already overwritten
+    _lost += behind - VisionRing::CAPACITY;
+    _tail = head - VisionRing::CAPACITY;
+  }
+
+  int n = 0;
+  while ((_tail != head) && (n < maxFrames)) {
+    const VisionRing::Slot& slot = _ring->slots[_tail % VisionRing::CAPACITY];
+    uint32_t expect = 2 * _tail + 2;
+
+    if (__atomic_load_n(&slot.seq, __ATOMIC_ACQUIRE) == expect) {
+      VisionFrame copy;
+      memcpy(&copy, (const void*) &slot.frame, sizeof(copy));
+
+      // Keep frame loads from moving after the second sequence load
+      __atomic_thread_fence(__ATOMIC_ACQUIRE);
+      if (__atomic_load_n(&slot.seq, __ATOMIC_RELAXED) == expect) {
+        frames[n++] = copy;
+      } else {
+        _lost++;
+      }
+    } else {
+      // Writer lapped us while we were reading
+      _lost++;
+    }
+    _tail++;
+  }
+  return n;
+}
+
+void VisionReader::skipToLatest() {
+  _haveLast = false;
+  if (_ring != 0) {
+    uint32_t head = __atomic_load_n(&_ring->head, __ATOMIC_ACQUIRE);
+    _tail = (head > 0) ? head - 1 : 0;
+  }
+}
@@ -0,0 +1,126 @@
+/**
+ * Definition of the VisionReader class.
+ */
+#ifndef __avc_VisionReader_h
+#define __avc_VisionReader_h
+
+#include "FileData.h"
+
+#include <string>
+
+namespace avc {
+
+  /**
+   * Reads the FileData records avc-vision publishes through a memory
+   * mapped view of the shared memory file.
+   *
+   * <p>If the file is large enough to hold a VisionRing (and the
+   * writer has initialized it), {@link #drain} returns every frame
+   * published since the prior call. Otherwise it falls back to the
+   * single latest record.</p>
+   *
+   * <p>Once opened, reads are sequence lock reads of mapped memory
+   * (no system calls and they never sleep).</p>
+   */
+  class VisionReader {
+
+  public:
+    VisionReader();
+
+    /**
+     * Unmaps the file.
+     */
+    ~VisionReader();
+
+    /**
+     * Maps the shared memory file.
+     *
+     * @param path The file avc-vision publishes to (like
+     * "/dev/shm/stanchions").
+     *
+     * @return true if the file was mapped (it must already exist and
+     * be at least sizeof(FileData) bytes).
+     */
+    bool open(const std::string& path);
+
+    /**
+     * Unmaps the shared memory file.
+     */
+    void close();
+
+    /**
+     * Returns true if the file is mapped.
+     */
+    bool isOpen() const { return _latest != 0; }
+
+    /**
+     * Returns true if the file is large enough to hold a VisionRing.
+     */
+    bool hasRing() const { return _ring != 0; }
+
+    /**
+     * Makes a consistent copy of the latest record.
+     *
+     * <p>If the writer is in the middle of an update we spin briefly
+     * and retry (the writer only needs to store a few words).</p>
+     *
+     * @param data Where to copy the record to (only modified if a
+     * consistent copy was made).
+     *
+     * @return true if a consistent copy was made, false if not mapped
+     * or writer did not finish its update in time.
+     */
+    bool read(FileData& data) const;
+
+    /**
+     * Copies the frames published since the prior call (oldest first).
+     *
+     * <p>Without a ring, this returns the latest record if its frame
+     * count changed (time stamp will be 0).</p>
+     *
+     * @param frames Where to copy the frames to.
+     *
+     * @param maxFrames Maximum number of frames to copy (any others
+     * are returned by the next call).
+     *
+     * @return Number of frames copied or -1 if unable to read.
+     */
+    int drain(VisionFrame* frames, int maxFrames);
+
+    /**
+     * Skip over all frames except the most recent one (so the next
+     * {@link #drain} only returns the latest and newer frames).
+     */
+    void skipToLatest();
+
+    /**
+     * Returns how many frames were overwritten before we could read
+     * them (we fell more than a ring behind).
+     */
+    unsigned getLostFrames() const { return _lost; }
+
+  private:
+    // Hide copy constructor (we own the mapping)
+    VisionReader(const VisionReader&);
+
+    // Start of mapping (null if not mapped)
+    void* _mem;
+    // Number of bytes mapped
+    size_t _memSize;
+    // Latest record (start of mapping)
+    const FileData* _latest;
+    // Ring (null if file is too small)
+    const VisionRing* _ring;
+    // Index of next frame to read from the ring
+    uint32_t _tail;
+    // Number of frames lost
+    unsigned _lost;
+    // Frame count of last record returned by drain() without a ring
+    int _lastFrameCount;
+    // Whether _lastFrameCount is valid
+    bool _haveLast;
+  };
+
+}
+
+#endif
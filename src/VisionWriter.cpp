@@ -0,0 +1,108 @@
+/**
+ * Implementation of the VisionWriter class.
+ */
+
+#include "VisionWriter.h"
+
+#include <iostream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+using namespace avc;
+using namespace std;
+
+VisionWriter::VisionWriter() :
+  _ring(0),
+  _notify(),
+  _frameCount(0)
+{
+}
+
+VisionWriter::~VisionWriter() {
+  close();
+}
+
+bool VisionWriter::open(const string& path, const string& notifyPath) {
+  close();
+
+  int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+  if (fd < 0) {
+    cerr << "***ERROR*** Unable to open vision file: " << path << "\n";
+    return false;
+  }
+
+  if (ftruncate(fd, sizeof(VisionRing)) != 0) {
+    cerr << "***ERROR*** Unable to size vision file: " << path << "\n";
+    ::close(fd);
+    return false;
+  }
+
+  void* mem = mmap(0, sizeof(VisionRing), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  ::close(fd);
+
+  if (mem == MAP_FAILED) {
+    cerr << "***ERROR*** Unable to map vision file: " << path << "\n";
+    return false;
+  }
+
+  _ring = static_cast<VisionRing*>(mem);
+  _frameCount = 0;
+
+  // Readers fall back to the latest record while we reset the ring
+  __atomic_store_n(&_ring->magic, 0, __ATOMIC_RELEASE);
+  _ring->capacity = VisionRing::CAPACITY;
+  for (uint32_t i = 0; i < VisionRing::CAPACITY; i++) {
+    __atomic_store_n(&_ring->slots[i].seq, 0, __ATOMIC_RELAXED);
+  }
+  __atomic_store_n(&_ring->head, 0, __ATOMIC_RELEASE);
+  __atomic_store_n(&_ring->magic, VisionRing::MAGIC, __ATOMIC_RELEASE);
+
+  if (!notifyPath.empty() && !_notify.openFifo(notifyPath)) {
+    cerr << "WARNING: Unable to open notification FIFO: " << notifyPath << "\n";
+  }
+  return true;
+}
+
+void VisionWriter::close() {
+  if (_ring != 0) {
+    munmap(_ring, sizeof(VisionRing));
+    _ring = 0;
+  }
+  _notify.close();
+}
+
+void VisionWriter::publish(const FileData& data, int64_t timeNanos) {
+  if (_ring == 0) {
+    return;
+  }
+
+  int frameCount = ++_frameCount;
+  uint32_t idx = (uint32_t) (frameCount - 1);
+
+  FileData record(data);
+  record.frameCount = record.safetyFrameCount = frameCount;
+
+  // Ring slot: odd sequence while writing, even once complete
+  VisionRing::Slot& slot = _ring->slots[idx % VisionRing::CAPACITY];
+  __atomic_store_n(&slot.seq, 2 * idx + 1, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+  slot.frame.timeNanos = timeNanos;
+  slot.frame.data = record;
+  __atomic_store_n(&slot.seq, 2 * idx + 2, __ATOMIC_RELEASE);
+  __atomic_store_n(&_ring->head, idx + 1, __ATOMIC_RELEASE);
+
+  // Latest record: frameCount first, payload, safetyFrameCount last
+  FileData& latest = _ring->latest;
+  __atomic_store_n(&latest.frameCount, frameCount, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+  latest.found = record.found;
+  latest.boxWidth = record.boxWidth;
+  latest.boxHeight = record.boxHeight;
+  latest.xMid = record.xMid;
+  latest.yBot = record.yBot;
+  __atomic_store_n(&latest.safetyFrameCount, frameCount, __ATOMIC_RELEASE);
+
+  _notify.notify();
+}
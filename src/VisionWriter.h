@@ -0,0 +1,88 @@
+/**
+ * Definition of the VisionWriter class.
+ */
+#ifndef __avc_VisionWriter_h
+#define __avc_VisionWriter_h
+
+#include "FileData.h"
+#include "Reactor.h"
+
+#include <string>
+
+namespace avc {
+
+  /**
+   * Publishes FileData records to the shared memory file read by
+   * VisionReader (the producer side of the FileData and VisionRing
+   * sequence lock protocols).
+   *
+   * <pre>
+   * VisionWriter writer;
+   * writer.open("/dev/shm/stanchions", "/dev/shm/stanchions.notify");
+   *
+   * FileData data;
+   * data.found = Found::Red;
+   * writer.publish(data, captureTimeNanos);
+   * </pre>
+   */
+  class VisionWriter {
+
+  public:
+    VisionWriter();
+
+    /**
+     * Unmaps the file.
+     */
+    ~VisionWriter();
+
+    /**
+     * Creates (or resizes) and maps the shared memory file and resets
+     * the ring to empty.
+     *
+     * @param path The file to publish to (like "/dev/shm/stanchions").
+     *
+     * @param notifyPath Optional named FIFO to write a byte to after
+     * each frame is published (ignored if empty or not a FIFO).
+     *
+     * @return true if the file was mapped.
+     */
+    bool open(const std::string& path, const std::string& notifyPath = "");
+
+    /**
+     * Unmaps the shared memory file.
+     */
+    void close();
+
+    /**
+     * Returns true if the file is mapped.
+     */
+    bool isOpen() const { return _ring != 0; }
+
+    /**
+     * Returns the number of frames published since opened.
+     */
+    int getFrameCount() const { return _frameCount; }
+
+    /**
+     * Publishes the results of the next frame.
+     *
+     * @param data The detection results (frameCount and
+     * safetyFrameCount are filled in for you).
+     *
+     * @param timeNanos CLOCK_MONOTONIC time (in nanoseconds) when the
+     * frame was captured.
+     */
+    void publish(const FileData& data, int64_t timeNanos);
+
+  private:
+    // Hide copy constructor (we own the mapping)
+    VisionWriter(const VisionWriter&);
+
+    VisionRing* _ring;
+    NotifySource _notify;
+    int _frameCount;
+  };
+
+}
+
+#endif
@@ -0,0 +1,200 @@
+/**
+ * Compares the cost of a control loop tick through a plan built from
+ * CommandSequence/CommandParallel (vectors of pointers, virtual calls)
+ * with the same plan built from the Sequence/Parallel templates.
+ *
+ * The templates only pay off when the compiler is allowed to inline,
+ * so build it optimized (from a clean build directory):
+ *
+ *   make CXXFLAGS=-O2 avc-bench
+ *   build/avc-bench -n 2000
+ */
+
+#include "CommandArena.h"
+#include "CommandParallel.h"
+#include "CommandSequence.h"
+#include "CommandTemplates.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+using namespace avc;
+using namespace std;
+
+namespace {
+  // Ticks each step of the plan runs for
+  const int STEP_TICKS = 50;
+
+  // Keeps the optimizer from dropping the work of the commands
+  volatile float sink;
+
+  void usage(const char* cmd) {
+    cerr << "Usage: " << cmd << " [-n RUNS] [-r]\n\n"
+         << "  -n RUNS  Number of times to run each plan (default 1000)\n"
+         << "  -r       Commands read the real clock (includes the cost of"
+         << " clock_gettime)\n";
+  }
+
+  // Steps standing in for Timon's commands (a little arithmetic each tick)
+
+  class Hold : public Command {
+  public:
+    Hold(float power) : Command("Hold", 3600), _power(power), _left(0) { }
+    void doInitialize() { _left = STEP_TICKS; }
+    State doExecute() {
+      sink = _power;
+      return (--_left > 0) ? STILL_RUNNING : NORMAL_END;
+    }
+  private:
+    float _power;
+    int _left;
+  };
+
+  class Ramp : public Command {
+  public:
+    Ramp(float target) : Command("Ramp", 3600), _target(target), _power(0), _left(0) { }
+    void doInitialize() { _power = 0; _left = STEP_TICKS; }
+    State doExecute() {
+      _power += (_target - _power) * 0.1f;
+      sink = _power;
+      return (--_left > 0) ? STILL_RUNNING : NORMAL_END;
+    }
+  private:
+    float _target;
+    float _power;
+    int _left;
+  };
+
+  class Steer : public Command {
+  public:
+    Steer(float turn) : Command("Steer", 3600), _turn(turn), _turned(0), _last(0), _left(0) { }
+    void doInitialize() { _turned = _last = 0; _left = STEP_TICKS; }
+    State doExecute() {
+      float err = _turn - _turned;
+      float steer = err * 0.0028f + (_last - err) * 0.0001f;
+      _turned += steer * 10;
+      _last = err;
+      sink = steer;
+      return (--_left > 0) ? STILL_RUNNING : NORMAL_END;
+    }
+  private:
+    float _turn;
+    float _turned;
+    float _last;
+    int _left;
+  };
+
+  // Runs forever along side the drive sequence (like StatusLeds)
+  class Status : public Command {
+  public:
+    Status() : Command("Status", 3600), _ticks(0) { }
+    State doExecute() {
+      sink = (float) ++_ticks;
+      return STILL_RUNNING;
+    }
+  private:
+    int _ticks;
+  };
+
+  // Same shape as Timon's short way plan: 4 legs of 5 steps after a pause
+  void buildDynamic(CommandArena& arena, CommandParallel& top) {
+    CommandSequence* drive = arena.make<CommandSequence>("Drive", &arena);
+    drive->add(arena.make<Hold>(0));
+    for (int i = 0; i < 4; i++) {
+      CommandSequence* leg = arena.make<CommandSequence>("Leg", &arena);
+      leg->add(arena.make<Ramp>(0.15f));
+      leg->add(arena.make<Hold>(-1));
+      leg->add(arena.make<Ramp>(-0.15f));
+      leg->add(arena.make<Hold>(-1));
+      leg->add(arena.make<Steer>(90));
+      drive->add(leg);
+    }
+    top.add(drive);
+    top.add(arena.make<Status>());
+  }
+
+  typedef Sequence<Ramp, Hold, Ramp, Hold, Steer> Leg;
+
+  Leg makeLeg() {
+    return Leg("Leg", Ramp(0.15f), Hold(-1), Ramp(-0.15f), Hold(-1), Steer(90));
+  }
+
+  // Runs a plan to the end (returns number of ticks)
+  int runPlan(Command& plan) {
+    int ticks = 0;
+    plan.initialize();
+    Command::State state;
+    do {
+      state = Command::executeTick(plan);
+      ticks++;
+    } while (state == Command::STILL_RUNNING);
+    plan.end(state);
+    return ticks;
+  }
+
+  // Runs a plan many times and reports the cost per tick
+  double timePlan(ostream& out, const char* label, Command& plan, int runs) {
+    RealClock wallClock;
+    int64_t ticks = 0;
+
+    // Once to warm up caches
+    runPlan(plan);
+
+    int64_t start = wallClock.nowNanos();
+    for (int i = 0; i < runs; i++) {
+      ticks += runPlan(plan);
+    }
+    double nanosPerTick = (wallClock.nowNanos() - start) / (double) ticks;
+
+    out << label << ": " << ticks << " ticks, " << nanosPerTick << " nsecs per tick\n";
+    return nanosPerTick;
+  }
+}
+
+int main(int argc, const char** argv) {
+  int runs = 1000;
+  bool realClock = false;
+
+  for (int i = 1; i < argc; i++) {
+    if ((strcmp(argv[i], "-n") == 0) && (i + 1 < argc)) {
+      runs = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "-r") == 0) {
+      realClock = true;
+    } else {
+      usage(argv[0]);
+      return 1;
+    }
+  }
+
+  if (runs < 1) {
+    usage(argv[0]);
+    return 1;
+  }
+
+  // Time stands still for the commands unless asked for the real
+  // clock (timeouts are never reached either way)
+  VirtualClock virtualClock;
+  if (!realClock) {
+    Clock::setSource(&virtualClock);
+  }
+
+  CommandArena arena;
+  CommandParallel dynamicPlan("Timon", true, &arena);
+  buildDynamic(arena, dynamicPlan);
+
+  auto staticPlan = makeParallel("Timon", true,
+                                 makeSequence("Drive", Hold(0), makeLeg(), makeLeg(),
+                                              makeLeg(), makeLeg()),
+                                 Status());
+
+  // Both report each step they start and end, only time the work
+  cout.setstate(ios::badbit);
+  ostream report(cout.rdbuf());
+  double dynamicNanos = timePlan(report, "CommandSequence/CommandParallel", dynamicPlan, runs);
+  double staticNanos = timePlan(report, "Sequence/Parallel templates", staticPlan, runs);
+
+  report << "Templates take " << (100 * staticNanos / dynamicNanos)
+         << "% of the time per tick\n";
+  return 0;
+}
@@ -0,0 +1,108 @@
+/**
+ * Dumps the last few seconds of a flight recorder file written by
+ * the avc process (even if the process crashed or was killed).
+ *
+ * To compile/run:
+ *
+ *   make avc-flight
+ *   build/avc-flight -s 5 /var/log/avc/avc-flight.bin | less
+ */
+
+#include "FlightRecorder.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+
+using namespace avc;
+using namespace std;
+
+namespace {
+  // How many seconds prior to the last record to dump by default
+  const double DEFAULT_SECS = 10.0;
+
+  void usage(const char* cmd) {
+    cerr << "Usage: " << cmd << " [-a] [-s SECS] FILE\n\n"
+         << "  -a       Dump every record in the file\n"
+         << "  -s SECS  Dump records from the last SECS seconds (default "
+         << DEFAULT_SECS << ")\n";
+  }
+}
+
+int main(int argc, const char** argv) {
+  double secs = DEFAULT_SECS;
+  bool all = false;
+  const char* path = 0;
+
+  for (int i = 1; i < argc; i++) {
+    if ((strcmp(argv[i], "-s") == 0) && (i + 1 < argc)) {
+      secs = atof(argv[++i]);
+    } else if (strcmp(argv[i], "-a") == 0) {
+      all = true;
+    } else if ((path == 0) && (argv[i][0] != '-')) {
+      path = argv[i];
+    } else {
+      usage(argv[0]);
+      return 1;
+    }
+  }
+
+  if (path == 0) {
+    usage(argv[0]);
+    return 1;
+  }
+
+  FILE* in = fopen(path, "rb");
+  if (in == 0) {
+    cerr << "***ERROR*** Unable to open: " << path << "\n";
+    return 1;
+  }
+
+  FlightLog* log = new FlightLog;
+  size_t n = fread(log, sizeof(FlightLog), 1, in);
+  fclose(in);
+
+  if ((n != 1) || (log->magic != FlightLog::MAGIC)) {
+    cerr << "***ERROR*** Not a flight recorder file: " << path << "\n";
+    delete log;
+    return 1;
+  }
+  if ((log->recordSize != sizeof(FlightRecord)) || (log->capacity != FlightLog::CAPACITY)) {
+    cerr << "***ERROR*** Record layout (" << log->recordSize << " bytes, "
+         << log->capacity << " records) does not match this tool ("
+         << sizeof(FlightRecord) << " bytes, " << FlightLog::CAPACITY << " records)\n";
+    delete log;
+    return 1;
+  }
+
+  uint32_t head = log->head;
+  if (head == 0) {
+    cerr << "No records in: " << path << "\n";
+    delete log;
+    return 0;
+  }
+
+  // Oldest record still in the file
+  uint32_t first = (head > FlightLog::CAPACITY) ? (head - FlightLog::CAPACITY) : 0;
+  int64_t endNanos = log->records[(head - 1) % FlightLog::CAPACITY].timeNanos;
+  int64_t startNanos = all ? INT64_MIN : (endNanos - (int64_t) (secs * 1e9));
+
+  int count = 0;
+  cout << fixed << setprecision(3);
+  for (uint32_t i = first; i != head; i++) {
+    const FlightRecord& rec = log->records[i % FlightLog::CAPACITY];
+    if (rec.timeNanos < startNanos) {
+      continue;
+    }
+    // Time relative to the final record (in seconds)
+    cout << setw(9) << ((rec.timeNanos - endNanos) / 1e9) << " " << rec << "\n";
+    count++;
+  }
+
+  cerr << count << " of " << (head - first) << " records (" << head
+       << " added during run)\n";
+  delete log;
+  return 0;
+}
@@ -80,6 +80,15 @@ int main(int argc, const char** argv) {
       cout << heading 
 	   << " degrees off (" << (gyroReadTime.secsElapsed() * 1000.0)
 	   << " msecs to read)\n";
+
+      // Compare with a burst read of every channel
+      Timer burstReadTime;
+      if (gyro.update()) {
+	burstReadTime.pause();
+	cout << "All channels (" << (burstReadTime.secsElapsed() * 1000.0)
+	     << " msecs to read):\n";
+	gyro.dumpInfo(cout);
+      }
     } else {
       cerr << "Problem reading gyro data\n";
       break;
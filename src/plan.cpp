@@ -0,0 +1,78 @@
+/**
+ * Compiles a text course plan into the flat binary form timon loads
+ * (or dumps a compiled plan back to text).
+ *
+ * To compile/run:
+ *
+ *   make avc-plan
+ *   build/avc-plan plans/short.plan /etc/avc.conf.d/short.plan.bin
+ *   build/avc-plan -d /etc/avc.conf.d/short.plan.bin
+ */
+
+#include "AutonPlan.h"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+using namespace avc;
+using namespace std;
+
+namespace {
+  void usage(const char* cmd) {
+    cerr << "Usage: " << cmd << " PLAN [OUT]\n"
+         << "       " << cmd << " -d OUT\n\n"
+         << "  PLAN  Text plan to check (and compile to OUT when given)\n"
+         << "  -d    Dump a compiled plan as text\n";
+  }
+}
+
+int main(int argc, const char** argv) {
+  bool dump = false;
+  const char* paths[2] = { 0, 0 };
+  int pathCount = 0;
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "-d") == 0) {
+      dump = true;
+    } else if ((pathCount < 2) && (argv[i][0] != '-')) {
+      paths[pathCount++] = argv[i];
+    } else {
+      usage(argv[0]);
+      return 1;
+    }
+  }
+
+  if ((pathCount == 0) || (dump && (pathCount != 1))) {
+    usage(argv[0]);
+    return 1;
+  }
+
+  AutonPlan plan;
+  bool ok;
+
+  if (dump) {
+    ok = plan.load(paths[0]);
+  } else {
+    ifstream in(paths[0]);
+    if (!in) {
+      cerr << "***ERROR*** Unable to open: " << paths[0] << "\n";
+      ok = false;
+    } else {
+      ok = plan.parse(in, paths[0]);
+    }
+    if (ok && (paths[1] != 0)) {
+      ok = plan.save(paths[1]);
+    }
+  }
+
+  if (ok) {
+    if (dump || (paths[1] == 0)) {
+      cout << plan;
+    } else {
+      cout << "Wrote " << plan.count << " steps to " << paths[1] << "\n";
+    }
+  }
+
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,123 @@
+/**
+ * Replays sensor recordings made by the avc process through the
+ * current control code and reports any tick where the motor power
+ * (or command state) differs from what was recorded.
+ *
+ * To compile/run:
+ *
+ *   make HAL=memory CXX=g++ avc-replay
+ *   build-memory/avc-replay avc-sensors.bin
+ */
+
+#include "Replay.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+using namespace avc;
+using namespace std;
+
+namespace {
+  // Largest difference in motor power still considered the same
+  const float DEFAULT_TOLERANCE = 1e-4;
+
+  void usage(const char* cmd) {
+    cerr << "Usage: " << cmd << " [-e TOLERANCE] [-q] [-v] FILE...\n\n"
+         << "  -e TOLERANCE  Largest difference in motor power that still matches"
+         << " (default " << DEFAULT_TOLERANCE << ")\n"
+         << "  -q            Only show the summary of each file (not each difference)\n"
+         << "  -v            Show Timon's own output\n";
+  }
+
+  // Replays a single recording (returns false if it didn't match)
+  bool replayFile(const char* path, float tolerance, bool quiet, bool verbose, ostream& out) {
+    vector<SensorTick> ticks;
+    bool longWay;
+    AutonPlan plan;
+    if (!SensorRecorder::load(path, ticks, longWay, plan)) {
+      return false;
+    }
+    const AutonPlan* planRun = (plan.count != 0) ? &plan : 0;
+
+    RealClock wallClock;
+    int64_t startNanos = wallClock.nowNanos();
+
+    // Timon is chatty, only show what it has to say if asked
+    if (!verbose) {
+      cout.setstate(ios::badbit);
+      cerr.setstate(ios::badbit);
+    }
+
+    // A fresh car for each recording so nothing carries over
+    Timon car;
+    Replay replay(car);
+    int mismatches = replay.run(ticks, longWay, planRun, tolerance, quiet ? 0 : &out);
+
+    cout.clear();
+    cerr.clear();
+    if (mismatches < 0) {
+      cerr << "***ERROR*** Unable to replay: " << path << "\n";
+      return false;
+    }
+
+    double runSecs = (ticks.back().timeNanos - ticks.front().timeNanos) / 1e9;
+    out << path << ": " << replay.getTicks() << " ticks (" << runSecs << " secs, "
+        << (longWay ? "long" : "short") << " way, ";
+    if (planRun != 0) {
+      out << planRun->count << " step plan";
+    } else {
+      out << "built in auton";
+    }
+    out << ") replayed in "
+        << ((wallClock.nowNanos() - startNanos) / 1e6) << " msecs, "
+        << mismatches << " differ (max power difference " << replay.getMaxDiff() << ")\n";
+    if (replay.getTruncatedTicks() > 0) {
+      out << "  WARNING: " << replay.getTruncatedTicks()
+          << " ticks read more vision frames than were recorded\n";
+    }
+    return mismatches == 0;
+  }
+}
+
+int main(int argc, const char** argv) {
+  float tolerance = DEFAULT_TOLERANCE;
+  bool quiet = false;
+  bool verbose = false;
+  vector<const char*> paths;
+
+  for (int i = 1; i < argc; i++) {
+    if ((strcmp(argv[i], "-e") == 0) && (i + 1 < argc)) {
+      tolerance = atof(argv[++i]);
+    } else if (strcmp(argv[i], "-q") == 0) {
+      quiet = true;
+    } else if (strcmp(argv[i], "-v") == 0) {
+      verbose = true;
+    } else if (argv[i][0] != '-') {
+      paths.push_back(argv[i]);
+    } else {
+      usage(argv[0]);
+      return 1;
+    }
+  }
+
+  if (paths.empty() || (tolerance < 0)) {
+    usage(argv[0]);
+    return 1;
+  }
+
+  // Report on a separate stream so Timon's output can be silenced
+  ostream report(cout.rdbuf());
+
+  int failed = 0;
+  for (size_t i = 0; i < paths.size(); i++) {
+    if (!replayFile(paths[i], tolerance, quiet, verbose, report)) {
+      failed++;
+    }
+  }
+
+  if (paths.size() > 1) {
+    report << (paths.size() - failed) << " of " << paths.size() << " recordings match\n";
+  }
+  return (failed == 0) ? 0 : 1;
+}
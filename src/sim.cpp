@@ -0,0 +1,173 @@
+/**
+ * Runs Timon's autons against the simulator (much faster than real
+ * time, on all cores) and reports how well the runs went.
+ */
+
+#include "MonteCarlo.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+
+using namespace avc;
+using namespace std;
+
+namespace {
+  const int DEFAULT_RATE_HZ = 20;
+  const float DEFAULT_MAX_SECS = 120;
+
+  void usage(const char* cmd) {
+    cerr << "Usage: " << cmd << " [-a long|short] [-j THREADS] [-l] [-n RUNS] [-o FILE]\n"
+         << "         [-p NAME=V1,V2,...] [-r RATE_HZ] [-s SEED] [-t SECS] [-u FRACTION] [-v]\n\n"
+         << "  -a PATH      Run the long or short path auton (default short)\n"
+         << "  -j THREADS   Number of runs to do at once (default one per core)\n"
+         << "  -l           List the outcome of every run\n"
+         << "  -n RUNS      Number of runs (seeds) for each set of values (default 1)\n"
+         << "  -o FILE      Record the sensors of the first run (replay with avc-replay)\n"
+         << "  -p NAME=VALS Try each of the comma separated values for a TimonTuning\n"
+         << "               or SimParams value (repeat to try every combination)\n"
+         << "  -r RATE_HZ   How many times per simulated second to run the control loop"
+         << " (default " << DEFAULT_RATE_HZ << ")\n"
+         << "  -s SEED      Seed of the first run (default 1)\n"
+         << "  -t SECS      Give up on a run after this many simulated seconds"
+         << " (default " << DEFAULT_MAX_SECS << ")\n"
+         << "  -u FRACTION  Randomly vary the car's speed, lags, scrub, drift and camera\n"
+         << "               latency by up to this fraction on each run (default 0)\n"
+         << "  -v           Show Timon's own output (one run at a time)\n\n"
+         << "Tuning values: " << TimonTuning() << "\n";
+  }
+
+  // Applies a value to the tuning or simulator parameters
+  bool setValue(SimConfig& config, const string& name, float value) {
+    return config.tuning.set(name, value) || config.params.set(name, value);
+  }
+
+  // Adds a value to sweep over, every existing configuration is tried
+  // with each of the values
+  bool addSweep(vector<SimConfig>& configs, const string& spec) {
+    size_t equals = spec.find('=');
+    if ((equals == string::npos) || (equals == 0)) {
+      return false;
+    }
+    string name = spec.substr(0, equals);
+    vector<SimConfig> swept;
+    stringstream values(spec.substr(equals + 1));
+    string value;
+
+    while (getline(values, value, ',')) {
+      char* end;
+      float val = strtof(value.c_str(), &end);
+      if (value.empty() || (*end != '\0')) {
+        return false;
+      }
+      for (size_t i = 0; i < configs.size(); i++) {
+        SimConfig config(configs[i]);
+        if (!setValue(config, name, val)) {
+          cerr << "***ERROR*** No tuning or simulator value named \"" << name << "\"\n";
+          return false;
+        }
+        config.label += (config.label.empty() ? "" : " ") + name + "=" + value;
+        swept.push_back(config);
+      }
+    }
+    if (swept.empty()) {
+      return false;
+    }
+    configs.swap(swept);
+    return true;
+  }
+}
+
+int main(int argc, const char** argv) {
+  bool longWay = false;
+  int runs = 1;
+  int threads = 0;
+  int rateHz = DEFAULT_RATE_HZ;
+  uint32_t seed = 1;
+  float maxSecs = DEFAULT_MAX_SECS;
+  float jitter = 0;
+  bool listRuns = false;
+  bool verbose = false;
+  const char* recordPath = "";
+  vector<SimConfig> configs(1);
+
+  for (int i = 1; i < argc; i++) {
+    if ((strcmp(argv[i], "-a") == 0) && (i + 1 < argc)) {
+      const char* path = argv[++i];
+      if ((strcmp(path, "long") != 0) && (strcmp(path, "short") != 0)) {
+        usage(argv[0]);
+        return 1;
+      }
+      longWay = (strcmp(path, "long") == 0);
+    } else if ((strcmp(argv[i], "-j") == 0) && (i + 1 < argc)) {
+      threads = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "-l") == 0) {
+      listRuns = true;
+    } else if ((strcmp(argv[i], "-n") == 0) && (i + 1 < argc)) {
+      runs = atoi(argv[++i]);
+    } else if ((strcmp(argv[i], "-o") == 0) && (i + 1 < argc)) {
+      recordPath = argv[++i];
+    } else if ((strcmp(argv[i], "-p") == 0) && (i + 1 < argc)) {
+      if (!addSweep(configs, argv[++i])) {
+        usage(argv[0]);
+        return 1;
+      }
+    } else if ((strcmp(argv[i], "-r") == 0) && (i + 1 < argc)) {
+      rateHz = atoi(argv[++i]);
+    } else if ((strcmp(argv[i], "-s") == 0) && (i + 1 < argc)) {
+      seed = strtoul(argv[++i], 0, 10);
+    } else if ((strcmp(argv[i], "-t") == 0) && (i + 1 < argc)) {
+      maxSecs = atof(argv[++i]);
+    } else if ((strcmp(argv[i], "-u") == 0) && (i + 1 < argc)) {
+      jitter = atof(argv[++i]);
+    } else if (strcmp(argv[i], "-v") == 0) {
+      verbose = true;
+    } else {
+      usage(argv[0]);
+      return 1;
+    }
+  }
+
+  if ((rateHz < 1) || (rateHz > 1000) || (runs < 1) || (maxSecs <= 0) ||
+      (jitter < 0) || (jitter >= 1)) {
+    usage(argv[0]);
+    return 1;
+  }
+
+  // Timon is chatty, only show what it has to say if asked (a failed
+  // stream skips the formatting, so this also keeps the runs fast)
+  if (verbose) {
+    threads = 1;
+  } else {
+    cout.setstate(ios::badbit);
+    cerr.setstate(ios::badbit);
+  }
+
+  MonteCarlo monteCarlo(longWay, rateHz, maxSecs);
+  monteCarlo.setRecordPath(recordPath);
+  for (size_t i = 0; i < configs.size(); i++) {
+    monteCarlo.addConfig(configs[i]);
+  }
+  monteCarlo.run(runs, seed, threads, jitter);
+
+  cout.clear();
+  cerr.clear();
+  if (listRuns) {
+    monteCarlo.printOutcomes(cout);
+  }
+  monteCarlo.printSummary(cout);
+
+  const vector<SimOutcome>& outcomes = monteCarlo.getOutcomes();
+  double simSecs = 0;
+  int finished = 0;
+  for (size_t i = 0; i < outcomes.size(); i++) {
+    simSecs += outcomes[i].secs;
+    finished += outcomes[i].isFinished() ? 1 : 0;
+  }
+  cout << outcomes.size() << " runs (" << simSecs << " simulated secs) in "
+       << monteCarlo.getWallSecs() << " wall secs ("
+       << (simSecs / monteCarlo.getWallSecs()) << "x real time)\n";
+
+  return (finished == (int) outcomes.size()) ? 0 : 1;
+}
@@ -0,0 +1,91 @@
+/**
+ * Decodes a binary telemetry file written by the avc process into
+ * text (one line per record).
+ *
+ * To compile/run:
+ *
+ *   make avc-telemetry
+ *   build/avc-telemetry /var/log/avc/avc-telemetry.bin | less
+ */
+
+#include "Telemetry.h"
+
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+using namespace avc;
+using namespace std;
+
+namespace {
+  void usage(const char* cmd) {
+    cerr << "Usage: " << cmd << " [-r] FILE\n\n"
+         << "  -r  Show times relative to the first record (in milliseconds)\n";
+  }
+}
+
+int main(int argc, const char** argv) {
+  bool relative = false;
+  const char* path = 0;
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "-r") == 0) {
+      relative = true;
+    } else if ((path == 0) && (argv[i][0] != '-')) {
+      path = argv[i];
+    } else {
+      usage(argv[0]);
+      return 1;
+    }
+  }
+
+  if (path == 0) {
+    usage(argv[0]);
+    return 1;
+  }
+
+  FILE* in = fopen(path, "rb");
+  if (in == 0) {
+    cerr << "***ERROR*** Unable to open: " << path << "\n";
+    return 1;
+  }
+
+  TelemetryLog::Header header;
+  if ((fread(&header, sizeof(header), 1, in) != 1) ||
+      (header.magic != TelemetryLog::MAGIC)) {
+    cerr << "***ERROR*** Not a telemetry file: " << path << "\n";
+    fclose(in);
+    return 1;
+  }
+  if (header.recordSize != sizeof(TelemetryRecord)) {
+    cerr << "***ERROR*** Record size " << header.recordSize
+         << " does not match this decoder (" << sizeof(TelemetryRecord) << ")\n";
+    fclose(in);
+    return 1;
+  }
+
+  TelemetryRecord rec;
+  int64_t startNanos = -1;
+  uint32_t expectSeq = 0;
+  int count = 0;
+  int gaps = 0;
+
+  while (fread(&rec, sizeof(rec), 1, in) == 1) {
+    if (startNanos < 0) {
+      startNanos = (relative ? rec.timeNanos : 0);
+    } else if (rec.seq != expectSeq) {
+      // Records dropped by the logger (ring was full)
+      cout << "*** " << (rec.seq - expectSeq) << " records dropped\n";
+      gaps++;
+    }
+    expectSeq = rec.seq + 1;
+
+    rec.timeNanos -= startNanos;
+    cout << rec << "\n";
+    count++;
+  }
+  fclose(in);
+
+  cerr << count << " records (" << gaps << " gaps)\n";
+  return 0;
+}
@@ -0,0 +1,167 @@
+/**
+ * The avc-vision process. Grabs frames from the camera (or a
+ * directory of recorded PPM images), looks for red and yellow
+ * stanchions and publishes the results to the shared memory file the
+ * avc process reads.
+ *
+ * To compile/run:
+ *
+ *   make build/avc-vision
+ *
+ *   # Measure frame rate on a directory of recorded images
+ *   build/avc-vision -d /tmp/images -l 10 -o /tmp/stanchions
+ *
+ *   # On the robot (normally started by /etc/init.d/avc)
+ *   sudo build/avc-vision
+ *
+ * Use ^C to terminate.
+ */
+
+#include "FrameSource.h"
+#include "StanchionDetector.h"
+#include "Timer.h"
+#include "VisionWriter.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+
+#include <signal.h>
+
+using namespace avc;
+using namespace std;
+
+namespace {
+  // Flag will be set when user terminates via ^C or uses kill on process
+  bool hasBeenInterrupted = false;
+
+  void interrupted(int sig) {
+    hasBeenInterrupted = true;
+  }
+
+  // Where avc reads the results of each frame from
+  const char* VISION_FILE = "/dev/shm/stanchions";
+
+  // Camera we grab frames from on the robot
+  const char* CAMERA_DEVICE = "/dev/video0";
+
+  void usage(const char* cmd) {
+    cerr << "Usage: " << cmd << " [-c DIR] [-n N] [-d DIR] [-l LOOPS] [-o FILE] [-q] [-v DEVICE]\n\n"
+         << "  -c DIR     Save captured frames to DIR as PPM images\n"
+         << "  -n N       Only save every Nth frame (default 1)\n"
+         << "  -d DIR     Process the PPM images in DIR instead of the camera\n"
+         << "  -l LOOPS   How many times to process the images in DIR (default 1)\n"
+         << "  -o FILE    Where to publish results (default " << VISION_FILE << ")\n"
+         << "  -q         Don't print the results of each frame\n"
+         << "  -v DEVICE  Camera to use (default " << CAMERA_DEVICE << ")\n";
+  }
+
+  const char* foundName(Found found) {
+    return (found == Found::Red) ? "red" : ((found == Found::Yellow) ? "yellow" : "none");
+  }
+}
+
+int main(int argc, const char** argv) {
+  string outFile(VISION_FILE);
+  string device(CAMERA_DEVICE);
+  string imageDir;
+  string saveDir;
+  int saveEvery = 1;
+  int loops = 1;
+  bool quiet = false;
+
+  for (int i = 1; i < argc; i++) {
+    bool hasArg = (i + 1 < argc);
+    if ((strcmp(argv[i], "-c") == 0) && hasArg) {
+      saveDir = argv[++i];
+    } else if ((strcmp(argv[i], "-n") == 0) && hasArg) {
+      saveEvery = atoi(argv[++i]);
+    } else if ((strcmp(argv[i], "-d") == 0) && hasArg) {
+      imageDir = argv[++i];
+    } else if ((strcmp(argv[i], "-l") == 0) && hasArg) {
+      loops = atoi(argv[++i]);
+    } else if ((strcmp(argv[i], "-o") == 0) && hasArg) {
+      outFile = argv[++i];
+    } else if (strcmp(argv[i], "-q") == 0) {
+      quiet = true;
+    } else if ((strcmp(argv[i], "-v") == 0) && hasArg) {
+      device = argv[++i];
+    } else {
+      usage(argv[0]);
+      return 1;
+    }
+  }
+
+  if ((saveEvery < 1) || (loops < 1)) {
+    usage(argv[0]);
+    return 1;
+  }
+
+  signal(SIGINT, interrupted);
+  signal(SIGTERM, interrupted);
+
+  unique_ptr<FrameSource> source;
+  if (imageDir.empty()) {
+    V4l2Source* camera = new V4l2Source(device);
+    source.reset(camera);
+    if (!camera->isOpen()) {
+      return 1;
+    }
+  } else {
+    DirectorySource* dir = new DirectorySource(imageDir, true, loops);
+    source.reset(dir);
+    if (dir->size() == 0) {
+      cerr << "***ERROR*** No PPM images found in: " << imageDir << "\n";
+      return 1;
+    }
+  }
+
+  VisionWriter writer;
+  if (!writer.open(outFile, outFile + ".notify")) {
+    return 1;
+  }
+
+  StanchionDetector detector;
+  Image img;
+  FileData data;
+  int64_t timeNanos;
+  int frames = 0;
+  int found = 0;
+  float detectSecs = 0;
+  Timer runTime;
+
+  while (!hasBeenInterrupted && source->next(img, timeNanos)) {
+    Timer detectTime;
+    if (detector.detect(img, data)) {
+      found++;
+    }
+    writer.publish(data, timeNanos);
+    detectTime.pause();
+    detectSecs += detectTime.secsElapsed();
+    frames++;
+
+    if (!saveDir.empty() && ((frames % saveEvery) == 0)) {
+      char name[32];
+      snprintf(name, sizeof(name), "/frame-%06d.ppm", frames);
+      if (!img.savePpm(saveDir + name)) {
+        cerr << "WARNING: Unable to save image to: " << saveDir << name << "\n";
+      }
+    }
+
+    if (!quiet) {
+      cout << writer.getFrameCount() << " " << foundName(data.found)
+           << " w=" << data.boxWidth << " h=" << data.boxHeight
+           << " x=" << data.xMid << " y=" << data.yBot << "\n";
+    }
+  }
+  runTime.pause();
+
+  float secs = runTime.secsElapsed();
+  cout << "Processed " << frames << " frames (stanchion in " << found << ") in "
+       << secs << " secs (" << (secs > 0 ? frames / secs : 0) << " fps, detection only "
+       << (detectSecs > 0 ? frames / detectSecs : 0) << " fps)\n";
+
+  return 0;
+}